@@ -0,0 +1,66 @@
+#pragma once
+
+#include "ranges.h"
+
+#include <cstring>
+#include <memory_resource>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace memory {
+
+    // Monotonic arena: objects are bump-allocated from large blocks and are never freed one by one.
+    // Everything is released at once by Release() or by the destructor, so only trivially
+    // destructible objects may be created in it.
+    class MonotonicArena {
+    public:
+        explicit MonotonicArena(size_t initial_block_size = 64 * 1024)
+            : resource_(initial_block_size) {
+        }
+
+        MonotonicArena(const MonotonicArena&) = delete;
+        MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+        template <typename T, typename... Args>
+        T* Create(Args&&... args) {
+            static_assert(std::is_trivially_destructible_v<T>, "Arena objects are never destroyed");
+            return new (resource_.allocate(sizeof(T), alignof(T))) T{ std::forward<Args>(args)... };
+        }
+
+        std::string_view CopyString(std::string_view str) {
+            if (str.empty()) {
+                return {};
+            }
+            char* data = static_cast<char*>(resource_.allocate(str.size(), alignof(char)));
+            std::memcpy(data, str.data(), str.size());
+            return { data, str.size() };
+        }
+
+        template <typename T>
+        ranges::Span<T> CopyArray(const std::vector<T>& source) {
+            return CopyArray(source.data(), source.size());
+        }
+
+        template <typename T>
+        ranges::Span<T> CopyArray(const T* source, size_t size) {
+            static_assert(std::is_trivially_copyable_v<T>, "Arena arrays are copied bytewise");
+            if (size == 0) {
+                return {};
+            }
+            T* data = static_cast<T*>(resource_.allocate(sizeof(T) * size, alignof(T)));
+            std::memcpy(data, source, sizeof(T) * size);
+            return { data, size };
+        }
+
+        void Release() {
+            resource_.release();
+        }
+
+    private:
+        std::pmr::monotonic_buffer_resource resource_;
+    };
+
+} // namespace memory
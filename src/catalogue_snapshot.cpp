@@ -0,0 +1,62 @@
+#include "catalogue_snapshot.h"
+#include "serialization.h"
+
+#include <atomic>
+
+CatalogueSnapshot::CatalogueSnapshot(std::istream& base_input) {
+
+    render::MapSettings map_customizer;
+    if (!base_input || !DeserializeBase(base_input, catalogue_, route_settings_, map_customizer)) {
+        throw BaseLoadError("The input is not a serialized base");
+    }
+
+    render::MapProjector projector(map_customizer.GetWidth(), map_customizer.GetHeight(), map_customizer.GetPadding());
+    map_renderer_ = render::MapRenderer(std::move(map_customizer), projector);
+
+    router_builder_.emplace(catalogue_);
+    router_builder_->FillGraph(route_settings_);
+    router_.emplace(router_builder_->Build());
+}
+
+const transport_catalogue::TransportCatalogue& CatalogueSnapshot::GetCatalogue() const {
+    return catalogue_;
+}
+
+const TransportRouter& CatalogueSnapshot::GetRouter() const {
+    return *router_;
+}
+
+const render::MapRenderer& CatalogueSnapshot::GetRenderer() const {
+    return map_renderer_;
+}
+
+const RouteSettings& CatalogueSnapshot::GetRouteSettings() const {
+    return route_settings_;
+}
+
+size_t CatalogueSnapshot::GetMemoryUsage() const {
+
+    const auto& graph = router_->GetGraph();
+    size_t vertex_count = graph.GetVertexCount();
+
+    // Each routing table cell is an optional weight with an optional previous edge
+    size_t route_cell_size = sizeof(std::optional<std::pair<WayInfo, std::optional<graph::EdgeId>>>);
+    size_t routes_size = vertex_count * vertex_count * route_cell_size;
+    size_t graph_size = graph.GetEdgeCount() * (sizeof(graph::Edge<WayInfo>) + sizeof(graph::EdgeId));
+    size_t stops_size = catalogue_.GetStopsCount() * (sizeof(Stop) + 64);
+
+    return routes_size + graph_size + stops_size;
+}
+
+CatalogueSnapshotHolder::CatalogueSnapshotHolder(std::shared_ptr<const CatalogueSnapshot> snapshot) :
+    snapshot_(std::move(snapshot)) {
+
+}
+
+std::shared_ptr<const CatalogueSnapshot> CatalogueSnapshotHolder::Acquire() const {
+    return std::atomic_load(&snapshot_);
+}
+
+void CatalogueSnapshotHolder::Publish(std::shared_ptr<const CatalogueSnapshot> snapshot) {
+    std::atomic_store(&snapshot_, std::move(snapshot));
+}
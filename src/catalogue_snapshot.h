@@ -0,0 +1,66 @@
+#pragma once
+
+#include "domain.h"
+#include "map_renderer.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <istream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+
+// A base that can't be opened or is not a serialized base
+class BaseLoadError : public std::runtime_error {
+public:
+    using runtime_error::runtime_error;
+};
+
+// Everything needed to answer stat requests: the catalogue with the router and the renderer built
+// over it. A snapshot is immutable once constructed, so any number of readers may share it.
+class CatalogueSnapshot {
+public:
+
+    // Throws BaseLoadError if the input is not readable or not a serialized base
+    explicit CatalogueSnapshot(std::istream& base_input);
+
+    CatalogueSnapshot(const CatalogueSnapshot&) = delete;
+    CatalogueSnapshot& operator=(const CatalogueSnapshot&) = delete;
+
+    const transport_catalogue::TransportCatalogue& GetCatalogue() const;
+    const TransportRouter& GetRouter() const;
+    const render::MapRenderer& GetRenderer() const;
+    const RouteSettings& GetRouteSettings() const;
+
+    // Approximate heap footprint in bytes, dominated by the all-pairs routing table
+    size_t GetMemoryUsage() const;
+
+private:
+
+    transport_catalogue::TransportCatalogue catalogue_;
+    RouteSettings route_settings_;
+    render::MapRenderer map_renderer_;
+    // The router refers to the graph owned by its builder, both are created after the catalogue is loaded
+    std::optional<TransportRouterBuilder> router_builder_;
+    std::optional<TransportRouter> router_;
+};
+
+// Publishes snapshots to concurrent readers. A reader pins the current snapshot with Acquire() and
+// keeps using it even if a writer publishes the next one meanwhile; the old snapshot is freed
+// when its last reader drops it. The new snapshot is built by the writer beforehand, so
+// publication itself is a single pointer swap. Acquire and Publish are not lock-free: libstdc++
+// guards atomic shared_ptr access with a mutex from a shared pool, held only for the copy or
+// the swap, so a reader may wait that long for a writer or another reader.
+class CatalogueSnapshotHolder {
+public:
+
+    CatalogueSnapshotHolder() = default;
+    explicit CatalogueSnapshotHolder(std::shared_ptr<const CatalogueSnapshot> snapshot);
+
+    std::shared_ptr<const CatalogueSnapshot> Acquire() const;
+    void Publish(std::shared_ptr<const CatalogueSnapshot> snapshot);
+
+private:
+
+    std::shared_ptr<const CatalogueSnapshot> snapshot_;
+};
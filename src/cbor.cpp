@@ -0,0 +1,434 @@
+#include "cbor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+
+namespace cbor {
+
+    using namespace std::literals;
+
+    namespace {
+
+        enum MajorType : uint8_t {
+            UNSIGNED_INT = 0,
+            NEGATIVE_INT = 1,
+            BYTE_STRING = 2,
+            TEXT_STRING = 3,
+            ARRAY = 4,
+            MAP = 5,
+            TAG = 6,
+            SIMPLE = 7
+        };
+
+        // Additional information of a head, its low 5 bits: the argument follows in 1, 2, 4
+        // or 8 bytes, or the item has indefinite length. Simple items use it for the value
+        constexpr uint8_t ONE_BYTE_ARGUMENT = 24;
+        constexpr uint8_t INDEFINITE_LENGTH = 31;
+
+        enum SimpleValue : uint8_t {
+            FALSE_VALUE = 20,
+            TRUE_VALUE = 21,
+            NULL_VALUE = 22,
+            FLOAT16 = 25,
+            FLOAT32 = 26,
+            FLOAT64 = 27
+        };
+
+        constexpr char Head(uint8_t major_type, uint8_t additional) {
+            return static_cast<char>(major_type << 5 | additional);
+        }
+
+        constexpr char INDEFINITE_ARRAY = Head(ARRAY, INDEFINITE_LENGTH);
+        constexpr char INDEFINITE_MAP = Head(MAP, INDEFINITE_LENGTH);
+        constexpr char BREAK = Head(SIMPLE, INDEFINITE_LENGTH);
+
+        class Decoder {
+        public:
+            Decoder(const unsigned char* begin, const unsigned char* end)
+                : it_(begin)
+                , end_(end) {
+            }
+
+            json::Node LoadItem() {
+                const uint8_t initial = ReadByte();
+                const uint8_t major_type = initial >> 5;
+                const uint8_t additional = initial & 0x1f;
+
+                if (major_type == SIMPLE) {
+                    return LoadSimple(additional);
+                }
+                if (additional == INDEFINITE_LENGTH) {
+                    switch (major_type) {
+                    case TEXT_STRING:
+                        return LoadIndefiniteText();
+                    case ARRAY:
+                        return LoadArray(std::nullopt);
+                    case MAP:
+                        return LoadMap(std::nullopt);
+                    default:
+                        throw json::ParsingError("Malformed CBOR head"s);
+                    }
+                }
+
+                const uint64_t argument = ReadArgument(additional);
+
+                switch (major_type) {
+                case UNSIGNED_INT:
+                    if (argument <= static_cast<uint64_t>(std::numeric_limits<int>::max())) {
+                        return static_cast<int>(argument);
+                    }
+                    return static_cast<double>(argument);
+                case NEGATIVE_INT:
+                    // The value is -1 - argument
+                    if (argument <= static_cast<uint64_t>(std::numeric_limits<int>::max())) {
+                        return -1 - static_cast<int>(argument);
+                    }
+                    return -1.0 - static_cast<double>(argument);
+                case TEXT_STRING:
+                    return std::string(ReadText(argument));
+                case ARRAY:
+                    return LoadArray(argument);
+                case MAP:
+                    return LoadMap(argument);
+                case BYTE_STRING:
+                    throw json::ParsingError("CBOR byte strings have no JSON counterpart"s);
+                default:
+                    throw json::ParsingError("CBOR tags are not supported"s);
+                }
+            }
+
+            bool IsAtEnd() const {
+                return it_ == end_;
+            }
+
+        private:
+            uint8_t ReadByte() {
+                if (it_ == end_) {
+                    throw json::ParsingError("Unexpected end of CBOR data"s);
+                }
+                return *it_++;
+            }
+
+            // Big-endian integer of the given width
+            uint64_t ReadBigEndian(size_t size) {
+                if (static_cast<size_t>(end_ - it_) < size) {
+                    throw json::ParsingError("Unexpected end of CBOR data"s);
+                }
+                uint64_t value = 0;
+                for (size_t i = 0; i < size; ++i) {
+                    value = (value << 8) | *it_++;
+                }
+                return value;
+            }
+
+            uint64_t ReadArgument(uint8_t additional) {
+                if (additional < ONE_BYTE_ARGUMENT) {
+                    return additional;
+                }
+                if (additional > ONE_BYTE_ARGUMENT + 3) {
+                    throw json::ParsingError("Malformed CBOR head"s);
+                }
+                return ReadBigEndian(size_t{ 1 } << (additional - ONE_BYTE_ARGUMENT));
+            }
+
+            std::string_view ReadText(uint64_t size) {
+                if (static_cast<uint64_t>(end_ - it_) < size) {
+                    throw json::ParsingError("Unexpected end of CBOR data"s);
+                }
+                const std::string_view text(reinterpret_cast<const char*>(it_), static_cast<size_t>(size));
+                it_ += size;
+                return text;
+            }
+
+            // True and consumed if the next byte ends an indefinite-length item
+            bool ReadBreak() {
+                if (it_ != end_ && *it_ == static_cast<unsigned char>(BREAK)) {
+                    ++it_;
+                    return true;
+                }
+                return false;
+            }
+
+            json::Node LoadIndefiniteText() {
+                std::string result;
+                while (!ReadBreak()) {
+                    const uint8_t initial = ReadByte();
+                    if (initial >> 5 != TEXT_STRING || (initial & 0x1f) == INDEFINITE_LENGTH) {
+                        throw json::ParsingError("Chunks of a CBOR text string must be definite text strings"s);
+                    }
+                    result += ReadText(ReadArgument(initial & 0x1f));
+                }
+                return result;
+            }
+
+            // nullopt size for an indefinite-length array
+            json::Node LoadArray(std::optional<uint64_t> size) {
+                json::Array result;
+                if (size) {
+                    // Every item takes at least a byte, so a broken size can't make a huge reserve
+                    result.reserve(static_cast<size_t>(std::min<uint64_t>(*size, static_cast<uint64_t>(end_ - it_))));
+                    for (uint64_t i = 0; i < *size; ++i) {
+                        result.push_back(LoadItem());
+                    }
+                }
+                else {
+                    while (!ReadBreak()) {
+                        result.push_back(LoadItem());
+                    }
+                }
+                return result;
+            }
+
+            json::Node LoadMap(std::optional<uint64_t> size) {
+                json::Dict result;
+                for (uint64_t i = 0; size ? i < *size : !ReadBreak(); ++i) {
+                    json::Node key = LoadItem();
+                    if (!key.IsString()) {
+                        throw json::ParsingError("CBOR map keys must be text strings"s);
+                    }
+                    json::Node value = LoadItem();
+                    if (!result.emplace(key.AsString(), std::move(value)).second) {
+                        throw json::ParsingError("Duplicate key '"s + key.AsString() + "' have been found");
+                    }
+                }
+                return result;
+            }
+
+            json::Node LoadSimple(uint8_t additional) {
+                switch (additional) {
+                case FALSE_VALUE:
+                    return false;
+                case TRUE_VALUE:
+                    return true;
+                case NULL_VALUE:
+                    return nullptr;
+                case FLOAT16:
+                    return LoadHalf(static_cast<uint16_t>(ReadBigEndian(2)));
+                case FLOAT32: {
+                    const uint32_t bits = static_cast<uint32_t>(ReadBigEndian(4));
+                    float value;
+                    std::memcpy(&value, &bits, sizeof(value));
+                    return static_cast<double>(value);
+                }
+                case FLOAT64: {
+                    const uint64_t bits = ReadBigEndian(8);
+                    double value;
+                    std::memcpy(&value, &bits, sizeof(value));
+                    return value;
+                }
+                case INDEFINITE_LENGTH:
+                    throw json::ParsingError("Unexpected CBOR break"s);
+                default:
+                    throw json::ParsingError("CBOR simple value has no JSON counterpart"s);
+                }
+            }
+
+            // IEEE 754 half precision, as decoded in RFC 8949 Appendix D
+            static double LoadHalf(uint16_t half) {
+                const int exponent = (half >> 10) & 0x1f;
+                const int mantissa = half & 0x3ff;
+                double value;
+                if (exponent == 0) {
+                    value = std::ldexp(mantissa, -24);
+                }
+                else if (exponent != 31) {
+                    value = std::ldexp(mantissa + 1024, exponent - 25);
+                }
+                else {
+                    value = mantissa == 0 ? std::numeric_limits<double>::infinity() : std::numeric_limits<double>::quiet_NaN();
+                }
+                return (half & 0x8000) != 0 ? -value : value;
+            }
+
+            const unsigned char* it_;
+            const unsigned char* end_;
+        };
+
+    }  // namespace
+
+    json::Document Load(std::istream& input) {
+        return Load(std::string_view(json::ReadText(input)));
+    }
+
+    json::Document Load(std::string_view data) {
+        const auto* begin = reinterpret_cast<const unsigned char*>(data.data());
+        Decoder decoder(begin, begin + data.size());
+        json::Node root = decoder.LoadItem();
+        if (!decoder.IsAtEnd()) {
+            throw json::ParsingError("Unexpected data after the CBOR item"s);
+        }
+        return json::Document{ std::move(root) };
+    }
+
+    Writer::Writer(std::string& output)
+        : output_(output) {
+    }
+
+    Writer& Writer::Key(std::string_view key) {
+
+        if (scopes_.empty() || !scopes_.back().is_dict) {
+            throw std::logic_error("Can't insert a key into not a dict"s);
+        }
+        if (is_key_written_) {
+            throw std::logic_error("Can't add a new key until prev key is not completed"s);
+        }
+
+        Scope& scope = scopes_.back();
+        if (!scope.is_empty && key <= scope.last_key) {
+            throw std::logic_error("Key '"s + std::string(key) + "' doesn't follow '"s + scope.last_key + "'"s);
+        }
+        scope.is_empty = false;
+        scope.last_key = key;
+
+        WriteText(key);
+        is_key_written_ = true;
+
+        return *this;
+    }
+
+    Writer& Writer::Value(std::nullptr_t) {
+        BeforeValue();
+        output_ += Head(SIMPLE, NULL_VALUE);
+        return *this;
+    }
+
+    Writer& Writer::Value(bool value) {
+        BeforeValue();
+        output_ += Head(SIMPLE, value ? TRUE_VALUE : FALSE_VALUE);
+        return *this;
+    }
+
+    Writer& Writer::Value(int value) {
+        BeforeValue();
+        if (value >= 0) {
+            WriteHead(UNSIGNED_INT, static_cast<uint64_t>(value));
+        }
+        else {
+            WriteHead(NEGATIVE_INT, static_cast<uint64_t>(-1 - static_cast<int64_t>(value)));
+        }
+        return *this;
+    }
+
+    Writer& Writer::Value(double value) {
+        BeforeValue();
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        output_ += Head(SIMPLE, FLOAT64);
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            output_ += static_cast<char>(bits >> shift);
+        }
+        return *this;
+    }
+
+    Writer& Writer::Value(std::string_view value) {
+        BeforeValue();
+        WriteText(value);
+        return *this;
+    }
+
+    Writer& Writer::Value(const char* value) {
+        return Value(std::string_view(value));
+    }
+
+    Writer& Writer::StartDict() {
+        StartScope(true, INDEFINITE_MAP);
+        return *this;
+    }
+
+    Writer& Writer::StartArray() {
+        StartScope(false, INDEFINITE_ARRAY);
+        return *this;
+    }
+
+    Writer& Writer::EndDict() {
+        EndScope(true);
+        return *this;
+    }
+
+    Writer& Writer::EndArray() {
+        EndScope(false);
+        return *this;
+    }
+
+    bool Writer::IsComplete() const {
+        return is_root_written_ && scopes_.empty();
+    }
+
+    void Writer::BeforeValue() {
+
+        if (scopes_.empty()) {
+            if (is_root_written_) {
+                throw std::logic_error("The root value is already written"s);
+            }
+            is_root_written_ = true;
+            return;
+        }
+
+        if (scopes_.back().is_dict) {
+            if (!is_key_written_) {
+                throw std::logic_error("Can't insert a value to a dict without key"s);
+            }
+            is_key_written_ = false;
+        }
+    }
+
+    void Writer::StartScope(bool is_dict, char head) {
+        BeforeValue();
+        output_ += head;
+        scopes_.push_back({ is_dict, true, {} });
+    }
+
+    void Writer::EndScope(bool is_dict) {
+
+        if (scopes_.empty() || scopes_.back().is_dict != is_dict) {
+            throw std::logic_error(is_dict ? "Can't close not a dict"s : "Can't close not an array"s);
+        }
+        if (is_key_written_) {
+            throw std::logic_error("There is no value for the last key"s);
+        }
+
+        scopes_.pop_back();
+        output_ += BREAK;
+    }
+
+    void Writer::WriteHead(uint8_t major_type, uint64_t argument) {
+
+        if (argument < ONE_BYTE_ARGUMENT) {
+            output_ += Head(major_type, static_cast<uint8_t>(argument));
+            return;
+        }
+
+        // 1, 2, 4 or 8 bytes, whichever is the first to fit
+        uint8_t size_index = 0;
+        while (size_index < 3 && argument >> (8 << size_index) != 0) {
+            ++size_index;
+        }
+        output_ += Head(major_type, ONE_BYTE_ARGUMENT + size_index);
+        for (int shift = (8 << size_index) - 8; shift >= 0; shift -= 8) {
+            output_ += static_cast<char>(argument >> shift);
+        }
+    }
+
+    void Writer::WriteText(std::string_view value) {
+        WriteHead(TEXT_STRING, value.size());
+        output_ += value;
+    }
+
+    ArrayPrinter::ArrayPrinter(std::ostream& output)
+        : output_(output) {
+        output_.put(INDEFINITE_ARRAY);
+    }
+
+    void ArrayPrinter::Add(std::string_view serialized_element) {
+        output_ << serialized_element;
+    }
+
+    void ArrayPrinter::Finish() {
+        output_.put(BREAK);
+    }
+
+}  // namespace cbor
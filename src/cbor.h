@@ -0,0 +1,80 @@
+#pragma once
+
+#include "json.h"
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// CBOR (RFC 8949) encoding of the JSON data model. Null, booleans, ints, doubles, text strings,
+// arrays and maps with text keys map one to one onto json::Node, so a binary request reads into
+// the same Document as its text form. Byte strings, tags and other simple values are rejected
+namespace cbor {
+
+    // Decodes the data item that takes the whole input, errors are thrown as json::ParsingError.
+    // Integers that don't fit into int become doubles, as in json::Load
+    json::Document Load(std::istream& input);
+    json::Document Load(std::string_view data);
+
+    // Counterpart of json::Writer with the same calls and checks, keys in increasing order included.
+    // Containers are written with indefinite length, so nothing has to be counted in advance.
+    // Ints take the shortest head, doubles are always float64 and read back exactly
+    class Writer {
+    public:
+
+        explicit Writer(std::string& output);
+
+        Writer& Key(std::string_view key);
+
+        Writer& Value(std::nullptr_t);
+        Writer& Value(bool value);
+        Writer& Value(int value);
+        Writer& Value(double value);
+        Writer& Value(std::string_view value);
+        Writer& Value(const char* value);
+
+        Writer& StartDict();
+        Writer& StartArray();
+        Writer& EndDict();
+        Writer& EndArray();
+
+        // True once the root value is written and all containers are closed
+        bool IsComplete() const;
+
+    private:
+
+        struct Scope {
+            bool is_dict = false;
+            bool is_empty = true;
+            std::string last_key;
+        };
+
+        void BeforeValue();
+        void StartScope(bool is_dict, char head);
+        void EndScope(bool is_dict);
+        void WriteHead(uint8_t major_type, uint64_t argument);
+        void WriteText(std::string_view value);
+
+        std::string& output_;
+        std::vector<Scope> scopes_;
+        bool is_key_written_ = false;
+        bool is_root_written_ = false;
+    };
+
+    // Writes a top level array of encoded elements as an indefinite-length array
+    class ArrayPrinter {
+    public:
+
+        explicit ArrayPrinter(std::ostream& output);
+
+        void Add(std::string_view serialized_element);
+        void Finish();
+
+    private:
+        std::ostream& output_;
+    };
+
+}  // namespace cbor
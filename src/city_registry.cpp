@@ -0,0 +1,128 @@
+#include "city_registry.h"
+
+#include <fstream>
+#include <stdexcept>
+
+using namespace std::literals;
+
+CityRegistry::CityRegistry(const std::map<std::string, std::filesystem::path>& city_bases, size_t memory_budget) :
+    memory_budget_(memory_budget) {
+
+    for (const auto& [city_name, base_path] : city_bases) {
+        cities_[city_name].base_path = base_path;
+    }
+
+}
+
+bool CityRegistry::HasCity(std::string_view city) const {
+    return cities_.find(city) != cities_.end();
+}
+
+std::shared_ptr<const CatalogueSnapshot> CityRegistry::Acquire(std::string_view city_name) {
+
+    City& city = GetCity(city_name);
+
+    if (auto snapshot = AcquireLoaded(city)) {
+        return snapshot;
+    }
+
+    std::lock_guard load_lock(city.load_mutex);
+
+    // Another request could have loaded the city while this one waited for the lock
+    if (auto snapshot = AcquireLoaded(city)) {
+        return snapshot;
+    }
+
+    auto snapshot = LoadSnapshot(city.base_path);
+
+    SetLoaded(city, snapshot);
+    return snapshot;
+}
+
+void CityRegistry::Reload(std::string_view city_name) {
+
+    City& city = GetCity(city_name);
+
+    // Only loads of this city wait, requests keep getting the current snapshot meanwhile
+    std::lock_guard load_lock(city.load_mutex);
+    SetLoaded(city, LoadSnapshot(city.base_path));
+}
+
+std::shared_ptr<const CatalogueSnapshot> CityRegistry::LoadSnapshot(const std::filesystem::path& base_path) {
+
+    std::ifstream input(base_path, std::ios::binary);
+
+    try {
+        return std::make_shared<const CatalogueSnapshot>(input);
+    }
+    catch (const BaseLoadError&) {
+        throw BaseLoadError("Can't read the base "s + base_path.string());
+    }
+}
+
+CityRegistry::City& CityRegistry::GetCity(std::string_view city_name) {
+
+    auto city_it = cities_.find(city_name);
+
+    if (city_it == cities_.end()) {
+        throw std::out_of_range("Unknown city "s + std::string(city_name));
+    }
+
+    return city_it->second;
+}
+
+std::shared_ptr<const CatalogueSnapshot> CityRegistry::AcquireLoaded(City& city) {
+
+    auto snapshot = city.snapshot_holder.Acquire();
+
+    if (snapshot) {
+        city.last_use.store(uses_count_.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    return snapshot;
+}
+
+void CityRegistry::SetLoaded(City& city, std::shared_ptr<const CatalogueSnapshot> snapshot) {
+
+    // Replaced and evicted snapshots are freed after the lock is released, unless requests still hold them
+    std::vector<std::shared_ptr<const CatalogueSnapshot>> released_snapshots;
+
+    std::lock_guard lock(mutex_);
+
+    memory_used_ -= city.memory_usage;
+    city.memory_usage = snapshot->GetMemoryUsage();
+    memory_used_ += city.memory_usage;
+
+    released_snapshots.push_back(city.snapshot_holder.Acquire());
+    city.snapshot_holder.Publish(std::move(snapshot));
+    city.is_loaded = true;
+    city.last_use.store(uses_count_.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    EvictOverBudget(city, released_snapshots);
+}
+
+void CityRegistry::EvictOverBudget(const City& keep_city, std::vector<std::shared_ptr<const CatalogueSnapshot>>& evicted_snapshots) {
+
+    while (memory_budget_ != 0 && memory_used_ > memory_budget_) {
+
+        City* least_used_city = nullptr;
+
+        for (auto& [_, city] : cities_) {
+            if (city.is_loaded && &city != &keep_city
+                && (least_used_city == nullptr || city.last_use.load(std::memory_order_relaxed) < least_used_city->last_use.load(std::memory_order_relaxed))) {
+                least_used_city = &city;
+            }
+        }
+
+        if (least_used_city == nullptr) {
+            return;
+        }
+
+        evicted_snapshots.push_back(least_used_city->snapshot_holder.Acquire());
+        least_used_city->snapshot_holder.Publish(nullptr);
+        least_used_city->is_loaded = false;
+        memory_used_ -= least_used_city->memory_usage;
+        least_used_city->memory_usage = 0;
+    }
+
+}
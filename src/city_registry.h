@@ -0,0 +1,65 @@
+#pragma once
+
+#include "catalogue_snapshot.h"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Several city bases served by one process. A city is loaded from its base file on the first
+// request to it. When the loaded cities exceed the memory budget, the least recently used ones
+// are unloaded; requests already holding their snapshots finish normally.
+class CityRegistry {
+public:
+
+    // memory_budget is in bytes, 0 means no limit
+    CityRegistry(const std::map<std::string, std::filesystem::path>& city_bases, size_t memory_budget);
+
+    CityRegistry(const CityRegistry&) = delete;
+    CityRegistry& operator=(const CityRegistry&) = delete;
+
+    bool HasCity(std::string_view city) const;
+
+    // Throws std::out_of_range for an unknown city and BaseLoadError, naming the file, for a city
+    // whose base can't be read. Such a city stays unloaded, the next request tries again
+    std::shared_ptr<const CatalogueSnapshot> Acquire(std::string_view city);
+
+    // Reads the city base again into a new snapshot and publishes it. Requests keep being answered
+    // from the old snapshot while the new one is built, and the ones that acquired it finish with
+    // it. Throws as Acquire does, the old snapshot stays published then
+    void Reload(std::string_view city);
+
+private:
+
+    struct City {
+        std::filesystem::path base_path;
+        CatalogueSnapshotHolder snapshot_holder;
+        size_t memory_usage = 0;
+        // Stamped by every request without taking the registry mutex, only eviction compares them
+        std::atomic<uint64_t> last_use = 0;
+        bool is_loaded = false;
+        // Serializes loading of this city only, other cities stay available meanwhile
+        std::mutex load_mutex;
+    };
+
+    static std::shared_ptr<const CatalogueSnapshot> LoadSnapshot(const std::filesystem::path& base_path);
+
+    City& GetCity(std::string_view city);
+    std::shared_ptr<const CatalogueSnapshot> AcquireLoaded(City& city);
+    void SetLoaded(City& city, std::shared_ptr<const CatalogueSnapshot> snapshot);
+    // Unloads the least recently used cities but keep_city while over the budget. Their snapshots
+    // are moved to evicted_snapshots, so that the caller frees them after releasing the lock
+    void EvictOverBudget(const City& keep_city, std::vector<std::shared_ptr<const CatalogueSnapshot>>& evicted_snapshots);
+
+    std::map<std::string, City, std::less<>> cities_;
+    std::mutex mutex_;
+    size_t memory_budget_ = 0;
+    size_t memory_used_ = 0;
+    std::atomic<uint64_t> uses_count_ = 0;
+};
@@ -1,7 +1,10 @@
 #pragma once
 
 #include "geo.h"
+#include "ranges.h"
+
 #include <string>
+#include <string_view>
 #include <vector>
 
 enum class BusType
@@ -10,9 +13,10 @@ enum class BusType
     Forward
 };
 
+// Stops and buses are stored in the catalogue arena, names and stop sequences point into it
 struct Stop {
 
-    std::string stop_name;
+    std::string_view stop_name;
     geo::Coordinates coordinates;
 
     bool operator<(const Stop& rhs) const;
@@ -30,9 +34,19 @@ struct BusInformation {
 
 struct Bus {
 
-    std::string bus_name;
+    std::string_view bus_name;
     BusType type;
-    std::vector<Stop*> stops;
+    ranges::Span<Stop*> stops;
+    size_t unique_stops_count = 0;
+
+};
+
+// A bus going from one stop to another without transfers, span_count is the least number
+// of stops it passes between them
+struct DirectBus {
+
+    const Bus* bus = nullptr;
+    size_t span_count = 0;
 
 };
 
@@ -3,9 +3,52 @@
 
 namespace geo {
 
+    namespace {
+
+        const double EARTH_RADIUS = 6371000;
+        const double DEGREES_TO_RADIANS = 3.1415926535 / 180.0;
+        const double HALF_PI = 1.57079632679489661923;
+
+        // Taylor series of asin, truncation error below 3e-10 for |x| <= 0.5
+        inline double AsinSeries(double x) {
+            const double x2 = x * x;
+            double p = 2704156.0 / 419430400.0;
+            p = p * x2 + 705432.0 / 96468992.0;
+            p = p * x2 + 184756.0 / 22020096.0;
+            p = p * x2 + 48620.0 / 4980736.0;
+            p = p * x2 + 12870.0 / 1114112.0;
+            p = p * x2 + 135135.0 / 9676800.0;
+            p = p * x2 + 10395.0 / 599040.0;
+            p = p * x2 + 945.0 / 42240.0;
+            p = p * x2 + 105.0 / 3456.0;
+            p = p * x2 + 15.0 / 336.0;
+            p = p * x2 + 3.0 / 40.0;
+            p = p * x2 + 1.0 / 6.0;
+            return x + x * x2 * p;
+        }
+
+        // asin on [0, 1]: the upper half is folded with asin(x) = pi/2 - 2 * asin(sqrt((1 - x) / 2)).
+        // Both branches are evaluated and selected, abs() absorbs x = 1 + eps from rounding
+        inline double Asin(double x) {
+            const bool is_small = x <= 0.5;
+            const double folded = std::sqrt(std::abs(1.0 - x) * 0.5);
+            const double p = AsinSeries(is_small ? x : folded);
+            return is_small ? p : HALF_PI - 2.0 * p;
+        }
+
+        inline double HaversineToDistance(double half_lat_sin, double lat_cos_product, double half_lng_sin) {
+            const double h = half_lat_sin * half_lat_sin + lat_cos_product * half_lng_sin * half_lng_sin;
+            return 2.0 * EARTH_RADIUS * Asin(std::sqrt(h));
+        }
+
+    } // namespace
+
     double ComputeDistance(Coordinates from, Coordinates to) {
         using namespace std;
         static const double dr = 3.1415926535 / 180.0;
+        if (from.lat == to.lat && from.lng == to.lng) {
+            return 0.0;
+        }
         return acos(sin(from.lat * dr) * sin(to.lat * dr)
             + cos(from.lat * dr) * cos(to.lat * dr) * cos(abs(from.lng - to.lng) * dr))
             * 6371000;
@@ -15,4 +58,106 @@ namespace geo {
         return lat < rhs.lat && lng < rhs.lng;
     }
 
-}
\ No newline at end of file
+    QuantizedCoordinates Quantize(Coordinates coordinates) {
+        return { static_cast<int32_t>(std::lround(coordinates.lat * 1e6)), static_cast<int32_t>(std::lround(coordinates.lng * 1e6)) };
+    }
+
+    Coordinates Dequantize(QuantizedCoordinates coordinates) {
+        return { coordinates.lat_e6 / 1e6, coordinates.lng_e6 / 1e6 };
+    }
+
+    CoordinatesColumns::CoordinatesColumns(bool is_quantized) :
+        is_quantized_(is_quantized) {
+
+    }
+
+    void CoordinatesColumns::Reserve(size_t size) {
+        if (is_quantized_) {
+            lats_e6_.reserve(size);
+            lngs_e6_.reserve(size);
+        }
+        else {
+            lats_.reserve(size);
+            lngs_.reserve(size);
+        }
+    }
+
+    void CoordinatesColumns::Add(Coordinates coordinates) {
+        if (is_quantized_) {
+            QuantizedCoordinates quantized = Quantize(coordinates);
+            lats_e6_.push_back(quantized.lat_e6);
+            lngs_e6_.push_back(quantized.lng_e6);
+        }
+        else {
+            lats_.push_back(coordinates.lat);
+            lngs_.push_back(coordinates.lng);
+        }
+    }
+
+    Coordinates CoordinatesColumns::Get(size_t index) const {
+        return { GetLat(index), GetLng(index) };
+    }
+
+    double CoordinatesColumns::GetLat(size_t index) const {
+        return is_quantized_ ? lats_e6_[index] / 1e6 : lats_[index];
+    }
+
+    double CoordinatesColumns::GetLng(size_t index) const {
+        return is_quantized_ ? lngs_e6_[index] / 1e6 : lngs_[index];
+    }
+
+    size_t CoordinatesColumns::Size() const {
+        return is_quantized_ ? lats_e6_.size() : lats_.size();
+    }
+
+    bool CoordinatesColumns::IsQuantized() const {
+        return is_quantized_;
+    }
+
+    void CoordinatesTable::Reserve(size_t size) {
+        half_lat_sin.reserve(size);
+        half_lat_cos.reserve(size);
+        half_lng_sin.reserve(size);
+        half_lng_cos.reserve(size);
+        lat_cos.reserve(size);
+    }
+
+    void CoordinatesTable::Add(Coordinates coordinates) {
+        const double lat = coordinates.lat * DEGREES_TO_RADIANS;
+        const double lng = coordinates.lng * DEGREES_TO_RADIANS;
+        half_lat_sin.push_back(std::sin(lat / 2));
+        half_lat_cos.push_back(std::cos(lat / 2));
+        half_lng_sin.push_back(std::sin(lng / 2));
+        half_lng_cos.push_back(std::cos(lng / 2));
+        lat_cos.push_back(std::cos(lat));
+    }
+
+    size_t CoordinatesTable::Size() const {
+        return lat_cos.size();
+    }
+
+    void ComputeDistances(Coordinates from, const CoordinatesTable& to, size_t first, size_t last, double* result) {
+
+        const double lat = from.lat * DEGREES_TO_RADIANS;
+        const double lng = from.lng * DEGREES_TO_RADIANS;
+        const double from_half_lat_sin = std::sin(lat / 2);
+        const double from_half_lat_cos = std::cos(lat / 2);
+        const double from_half_lng_sin = std::sin(lng / 2);
+        const double from_half_lng_cos = std::cos(lng / 2);
+        const double from_lat_cos = std::cos(lat);
+
+        const double* to_half_lat_sin = to.half_lat_sin.data();
+        const double* to_half_lat_cos = to.half_lat_cos.data();
+        const double* to_half_lng_sin = to.half_lng_sin.data();
+        const double* to_half_lng_cos = to.half_lng_cos.data();
+        const double* to_lat_cos = to.lat_cos.data();
+
+        for (size_t i = first; i < last; ++i) {
+            // sin((b - a) / 2) = sin(b / 2) * cos(a / 2) - cos(b / 2) * sin(a / 2)
+            const double half_dlat_sin = to_half_lat_sin[i] * from_half_lat_cos - to_half_lat_cos[i] * from_half_lat_sin;
+            const double half_dlng_sin = to_half_lng_sin[i] * from_half_lng_cos - to_half_lng_cos[i] * from_half_lng_sin;
+            result[i - first] = HaversineToDistance(half_dlat_sin, from_lat_cos * to_lat_cos[i], half_dlng_sin);
+        }
+    }
+
+}
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
 namespace geo {
 
@@ -16,4 +19,63 @@ namespace geo {
 
     double ComputeDistance(Coordinates from, Coordinates to);
 
-}
\ No newline at end of file
+    // Coordinates in whole micro-degrees, at most about 0.06 m off the source point
+    struct QuantizedCoordinates {
+        int32_t lat_e6 = 0;
+        int32_t lng_e6 = 0;
+    };
+
+    QuantizedCoordinates Quantize(Coordinates coordinates);
+    Coordinates Dequantize(QuantizedCoordinates coordinates);
+
+    // Points by index in separate latitude and longitude arrays, so scans over coordinates
+    // don't pull anything else into the cache. The quantized mode keeps int32 micro-degrees,
+    // which halves the memory and is precise enough for rendering and search heuristics.
+    class CoordinatesColumns {
+    public:
+
+        explicit CoordinatesColumns(bool is_quantized = false);
+
+        void Reserve(size_t size);
+        void Add(Coordinates coordinates);
+
+        Coordinates Get(size_t index) const;
+        double GetLat(size_t index) const;
+        double GetLng(size_t index) const;
+
+        size_t Size() const;
+        bool IsQuantized() const;
+
+    private:
+
+        bool is_quantized_ = false;
+        std::vector<double> lats_;
+        std::vector<double> lngs_;
+        std::vector<int32_t> lats_e6_;
+        std::vector<int32_t> lngs_e6_;
+    };
+
+    // Structure-of-arrays table of points with the trigonometry needed by the haversine
+    // formula precomputed once, so batch queries against it are plain multiply-adds.
+    struct CoordinatesTable {
+
+        void Reserve(size_t size);
+        void Add(Coordinates coordinates);
+        size_t Size() const;
+
+        std::vector<double> half_lat_sin;
+        std::vector<double> half_lat_cos;
+        std::vector<double> half_lng_sin;
+        std::vector<double> half_lng_cos;
+        std::vector<double> lat_cos;
+    };
+
+    // Batch great-circle distances: result[i] = distance from `from` to the table point
+    // first + i, for i in [0, last - first). The kernel evaluates the haversine formula with a
+    // polynomial asin and has no calls into libm inside the loop, so it vectorizes.
+    // Relative error against the exact haversine distance on the same sphere is below 2e-9
+    // (well under a millimetre for city distances); results may differ from ComputeDistance
+    // in the last printed digits, because ComputeDistance uses the less stable acos form.
+    void ComputeDistances(Coordinates from, const CoordinatesTable& to, size_t first, size_t last, double* result);
+
+}
@@ -1,238 +1,806 @@
 #include "json.h"
+#include "thread_pool.h"
 
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
 #include <iterator>
+#include <limits>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
 
 namespace json {
 
     namespace {
         using namespace std::literals;
 
-        Node LoadNode(std::istream& input);
-        Node LoadString(std::istream& input);
+        size_t CountTrailingZeros(uint64_t word) {
+#if defined(__GNUC__)
+            return static_cast<size_t>(__builtin_ctzll(word));
+#else
+            size_t count = 0;
+            while ((word & 1) == 0) {
+                word >>= 1;
+                ++count;
+            }
+            return count;
+#endif
+        }
+
+        bool IsWhitespace(char c) {
+            return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+        }
+
+        bool IsStringEnd(char c) {
+            return c == '"' || c == '\\' || c == '\n' || c == '\r';
+        }
 
-        std::string LoadLiteral(std::istream& input) {
-            std::string s;
-            while (std::isalpha(input.peek())) {
-                s.push_back(static_cast<char>(input.get()));
+        // Characters Print writes as escape sequences: a quote, a backslash or a control character
+        bool IsEscaped(char c) {
+            return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+        }
+
+        bool IsStructural(char c) {
+            return c == '"' || c == ',' || c == '[' || c == ']' || c == '{' || c == '}';
+        }
+
+        // Byte classifiers that test a whole vector of the text at once and jump to the first
+        // match: the end of a run of plain string characters (quote, backslash or line break),
+        // the next character to escape on output, the end of a run of whitespace and the next
+        // character that can change the nesting (quote, comma or bracket). The tail shorter than
+        // a vector is tested bytewise
+#if defined(__AVX2__)
+        constexpr size_t VECTOR_SIZE = 32;
+
+        uint64_t MatchStringEnds(const char* it) {
+            const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+            const auto equals = [&bytes](char c) {
+                return _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(c));
+            };
+            const __m256i ends = _mm256_or_si256(_mm256_or_si256(equals('"'), equals('\\')), _mm256_or_si256(equals('\n'), equals('\r')));
+            return static_cast<uint32_t>(_mm256_movemask_epi8(ends));
+        }
+
+        uint64_t MatchEscaped(const char* it) {
+            const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+            const auto equals = [&bytes](char c) {
+                return _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(c));
+            };
+            // Control characters are the bytes below 0x20
+            const __m256i controls = _mm256_cmpeq_epi8(_mm256_min_epu8(bytes, _mm256_set1_epi8(0x1f)), bytes);
+            const __m256i escaped = _mm256_or_si256(_mm256_or_si256(equals('"'), equals('\\')), controls);
+            return static_cast<uint32_t>(_mm256_movemask_epi8(escaped));
+        }
+
+        uint64_t MatchNonSpaces(const char* it) {
+            const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+            // Whitespace is ' ' or a byte from '\t' to '\r'
+            const __m256i from_tab = _mm256_sub_epi8(bytes, _mm256_set1_epi8('\t'));
+            const __m256i control_spaces = _mm256_cmpeq_epi8(_mm256_min_epu8(from_tab, _mm256_set1_epi8('\r' - '\t')), from_tab);
+            const __m256i spaces = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' ')), control_spaces);
+            return static_cast<uint32_t>(~_mm256_movemask_epi8(spaces));
+        }
+
+        uint64_t MatchStructurals(const char* it) {
+            const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+            // Setting the 0x20 bit turns '[' and ']' into '{' and '}'
+            const __m256i folded = _mm256_or_si256(bytes, _mm256_set1_epi8(0x20));
+            const auto equals = [](__m256i value, char c) {
+                return _mm256_cmpeq_epi8(value, _mm256_set1_epi8(c));
+            };
+            const __m256i brackets = _mm256_or_si256(equals(folded, '{'), equals(folded, '}'));
+            const __m256i structurals = _mm256_or_si256(_mm256_or_si256(equals(bytes, '"'), equals(bytes, ',')), brackets);
+            return static_cast<uint32_t>(_mm256_movemask_epi8(structurals));
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        constexpr size_t VECTOR_SIZE = 16;
+
+        uint64_t MatchStringEnds(const char* it) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+            const auto equals = [&bytes](char c) {
+                return _mm_cmpeq_epi8(bytes, _mm_set1_epi8(c));
+            };
+            const __m128i ends = _mm_or_si128(_mm_or_si128(equals('"'), equals('\\')), _mm_or_si128(equals('\n'), equals('\r')));
+            return static_cast<uint16_t>(_mm_movemask_epi8(ends));
+        }
+
+        uint64_t MatchEscaped(const char* it) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+            const auto equals = [&bytes](char c) {
+                return _mm_cmpeq_epi8(bytes, _mm_set1_epi8(c));
+            };
+            // Control characters are the bytes below 0x20
+            const __m128i controls = _mm_cmpeq_epi8(_mm_min_epu8(bytes, _mm_set1_epi8(0x1f)), bytes);
+            const __m128i escaped = _mm_or_si128(_mm_or_si128(equals('"'), equals('\\')), controls);
+            return static_cast<uint16_t>(_mm_movemask_epi8(escaped));
+        }
+
+        uint64_t MatchNonSpaces(const char* it) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+            // Whitespace is ' ' or a byte from '\t' to '\r'
+            const __m128i from_tab = _mm_sub_epi8(bytes, _mm_set1_epi8('\t'));
+            const __m128i control_spaces = _mm_cmpeq_epi8(_mm_min_epu8(from_tab, _mm_set1_epi8('\r' - '\t')), from_tab);
+            const __m128i spaces = _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')), control_spaces);
+            return static_cast<uint16_t>(~_mm_movemask_epi8(spaces));
+        }
+
+        uint64_t MatchStructurals(const char* it) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+            // Setting the 0x20 bit turns '[' and ']' into '{' and '}'
+            const __m128i folded = _mm_or_si128(bytes, _mm_set1_epi8(0x20));
+            const auto equals = [](__m128i value, char c) {
+                return _mm_cmpeq_epi8(value, _mm_set1_epi8(c));
+            };
+            const __m128i brackets = _mm_or_si128(equals(folded, '{'), equals(folded, '}'));
+            const __m128i structurals = _mm_or_si128(_mm_or_si128(equals(bytes, '"'), equals(bytes, ',')), brackets);
+            return static_cast<uint16_t>(_mm_movemask_epi8(structurals));
+        }
+#else
+        // Without SIMD the searches below are plain bytewise loops
+        constexpr size_t VECTOR_SIZE = 1;
+
+        uint64_t MatchStringEnds(const char*) {
+            return 0;
+        }
+
+        uint64_t MatchEscaped(const char*) {
+            return 0;
+        }
+
+        uint64_t MatchNonSpaces(const char*) {
+            return 0;
+        }
+
+        uint64_t MatchStructurals(const char*) {
+            return 0;
+        }
+#endif
+
+        const char* FindStringEnd(const char* it, const char* end) {
+            if constexpr (VECTOR_SIZE > 1) {
+                for (; static_cast<size_t>(end - it) >= VECTOR_SIZE; it += VECTOR_SIZE) {
+                    if (const uint64_t mask = MatchStringEnds(it); mask != 0) {
+                        return it + CountTrailingZeros(mask);
+                    }
+                }
+            }
+            while (it != end && !IsStringEnd(*it)) {
+                ++it;
             }
-            return s;
+            return it;
         }
 
-        Node LoadArray(std::istream& input) {
-            std::vector<Node> result;
+        const char* FindEscaped(const char* it, const char* end) {
+            if constexpr (VECTOR_SIZE > 1) {
+                for (; static_cast<size_t>(end - it) >= VECTOR_SIZE; it += VECTOR_SIZE) {
+                    if (const uint64_t mask = MatchEscaped(it); mask != 0) {
+                        return it + CountTrailingZeros(mask);
+                    }
+                }
+            }
+            while (it != end && !IsEscaped(*it)) {
+                ++it;
+            }
+            return it;
+        }
 
-            for (char c; input >> c && c != ']';) {
-                if (c != ',') {
-                    input.putback(c);
+        const char* FindNonSpace(const char* it, const char* end) {
+            if constexpr (VECTOR_SIZE > 1) {
+                for (; static_cast<size_t>(end - it) >= VECTOR_SIZE; it += VECTOR_SIZE) {
+                    if (const uint64_t mask = MatchNonSpaces(it); mask != 0) {
+                        return it + CountTrailingZeros(mask);
+                    }
                 }
-                result.push_back(LoadNode(input));
             }
-            if (!input) {
-                throw ParsingError("Array parsing error"s);
+            while (it != end && IsWhitespace(*it)) {
+                ++it;
             }
-            return Node(std::move(result));
+            return it;
         }
 
-        Node LoadDict(std::istream& input) {
-            Dict dict;
+        const char* FindStructural(const char* it, const char* end) {
+            if constexpr (VECTOR_SIZE > 1) {
+                for (; static_cast<size_t>(end - it) >= VECTOR_SIZE; it += VECTOR_SIZE) {
+                    if (const uint64_t mask = MatchStructurals(it); mask != 0) {
+                        return it + CountTrailingZeros(mask);
+                    }
+                }
+            }
+            while (it != end && !IsStructural(*it)) {
+                ++it;
+            }
+            return it;
+        }
 
-            for (char c; input >> c && c != '}';) {
-                if (c == '"') {
-                    std::string key = LoadString(input).AsString();
-                    if (input >> c && c == ':') {
-                        if (dict.find(key) != dict.end()) {
-                            throw ParsingError("Duplicate key '"s + key + "' have been found");
+        // Finds the bracket that closes the array opened at begin, taking nesting and strings into
+        // account, and collects the commas between its elements. Brackets of both kinds only
+        // count depth, the parser checks that they match. nullptr if the text ends first
+        const char* ScanArray(const char* begin, const char* end, std::vector<const char*>& separators) {
+            size_t depth = 0;
+            for (const char* it = FindStructural(begin, end); it != end; it = FindStructural(it + 1, end)) {
+                switch (*it) {
+                case '"':
+                    // Skips the string as ReadString does: up to a quote that isn't escaped,
+                    // line breaks are not allowed
+                    it = FindStringEnd(it + 1, end);
+                    while (it != end && *it == '\\') {
+                        if (end - it < 2) {
+                            return nullptr;
                         }
-                        dict.emplace(std::move(key), LoadNode(input));
+                        it = FindStringEnd(it + 2, end);
                     }
-                    else {
-                        throw ParsingError(": is expected but '"s + c + "' has been found"s);
+                    if (it == end || *it != '"') {
+                        return nullptr;
                     }
+                    break;
+                case '[':
+                    [[fallthrough]];
+                case '{':
+                    ++depth;
+                    break;
+                case ']':
+                    [[fallthrough]];
+                case '}':
+                    if (--depth == 0) {
+                        return it;
+                    }
+                    break;
+                case ',':
+                    if (depth == 1) {
+                        separators.push_back(it);
+                    }
+                    break;
+                default:
+                    break;
                 }
-                else if (c != ',') {
-                    throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+            }
+            return nullptr;
+        }
+
+        // Recursive descent over one contiguous buffer. It keeps the leniency of the former istream
+        // based parser about separators in arrays. Strings may not hold raw line breaks and take
+        // the escapes \n, \t, \r, \b, \f, \", \\, \/ and \uXXXX, a character beyond the BMP as
+        // a surrogate pair, decoded to UTF-8.
+        // Derived builds arrays, dicts and strings, scalars are made by the Result constructors
+        template <typename Derived, typename Result>
+        class BasicParser {
+        public:
+
+            BasicParser(const char* begin, const char* end)
+                : it_(begin)
+                , end_(end) {
+            }
+
+            const char* GetPosition() const {
+                return it_;
+            }
+
+            static bool IsSpace(char c) {
+                return IsWhitespace(c);
+            }
+
+            Result LoadNode() {
+                char c;
+                if (!NextNonSpace(c)) {
+                    throw ParsingError("Unexpected EOF"s);
+                }
+                Derived& derived = static_cast<Derived&>(*this);
+                switch (c) {
+                case '[':
+                    return derived.LoadArray();
+                case '{':
+                    return derived.LoadDict();
+                case '"':
+                    return derived.LoadString();
+                case 't':
+                    [[fallthrough]];
+                case 'f':
+                    --it_;
+                    return LoadBool();
+                case 'n':
+                    --it_;
+                    return LoadNull();
+                default:
+                    --it_;
+                    return LoadNumber();
                 }
             }
-            if (!input) {
-                throw ParsingError("Dictionary parsing error"s);
+
+        protected:
+
+            static bool IsDigit(char c) {
+                return c >= '0' && c <= '9';
             }
-            return Node(std::move(dict));
-        }
 
-        Node LoadString(std::istream& input) {
-            auto it = std::istreambuf_iterator<char>(input);
-            auto end = std::istreambuf_iterator<char>();
-            std::string s;
-            while (true) {
-                if (it == end) {
-                    throw ParsingError("String parsing error");
+            static bool IsAlpha(char c) {
+                return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+            }
+
+            // Same as `input >> c`: skips whitespace and takes the next character
+            bool NextNonSpace(char& c) {
+                // Tokens mostly follow each other directly, a vector test only pays off on runs of spaces
+                if (it_ != end_ && IsSpace(*it_)) {
+                    it_ = FindNonSpace(it_, end_);
                 }
-                const char ch = *it;
-                if (ch == '"') {
-                    ++it;
-                    break;
+                if (it_ == end_) {
+                    return false;
                 }
-                else if (ch == '\\') {
-                    ++it;
-                    if (it == end) {
+                c = *it_++;
+                return true;
+            }
+
+            char Peek() const {
+                return it_ == end_ ? '\0' : *it_;
+            }
+
+            std::string_view LoadLiteral() {
+                const char* begin = it_;
+                while (it_ != end_ && IsAlpha(*it_)) {
+                    ++it_;
+                }
+                return { begin, static_cast<size_t>(it_ - begin) };
+            }
+
+            // Reads the rest of a string after its opening quote. The result is a view into the
+            // input when the string has no escapes, otherwise it is unescaped into buffer
+            std::string_view ReadString(std::string& buffer) {
+                const char* begin = it_;
+                it_ = FindStringEnd(it_, end_);
+                if (it_ != end_ && *it_ == '"') {
+                    return { begin, static_cast<size_t>(it_++ - begin) };
+                }
+
+                buffer.assign(begin, it_);
+                while (true) {
+                    if (it_ == end_) {
                         throw ParsingError("String parsing error");
                     }
-                    const char escaped_char = *(it);
+                    const char ch = *it_++;
+                    if (ch == '"') {
+                        break;
+                    }
+                    if (ch == '\n' || ch == '\r') {
+                        throw ParsingError("Unexpected end of line"s);
+                    }
+                    if (it_ == end_) {
+                        throw ParsingError("String parsing error");
+                    }
+                    const char escaped_char = *it_++;
                     switch (escaped_char) {
                     case 'n':
-                        s.push_back('\n');
+                        buffer.push_back('\n');
                         break;
                     case 't':
-                        s.push_back('\t');
+                        buffer.push_back('\t');
                         break;
                     case 'r':
-                        s.push_back('\r');
+                        buffer.push_back('\r');
+                        break;
+                    case 'b':
+                        buffer.push_back('\b');
+                        break;
+                    case 'f':
+                        buffer.push_back('\f');
                         break;
                     case '"':
-                        s.push_back('"');
+                        buffer.push_back('"');
                         break;
                     case '\\':
-                        s.push_back('\\');
+                        buffer.push_back('\\');
+                        break;
+                    case '/':
+                        buffer.push_back('/');
+                        break;
+                    case 'u':
+                        LoadUnicodeEscape(buffer);
                         break;
                     default:
                         throw ParsingError("Unrecognized escape sequence \\"s + escaped_char);
                     }
+
+                    // Copies the run of plain characters at once
+                    const char* run_begin = it_;
+                    it_ = FindStringEnd(it_, end_);
+                    buffer.append(run_begin, it_);
                 }
-                else if (ch == '\n' || ch == '\r') {
-                    throw ParsingError("Unexpected end of line"s);
-                }
-                else {
-                    s.push_back(ch);
+                return buffer;
+            }
+
+            // Reads the four hex digits of a \u escape
+            uint32_t ReadHexCode() {
+                uint32_t code = 0;
+                const char* code_end = end_ - it_ < 4 ? end_ : it_ + 4;
+                const auto [ptr, ec] = std::from_chars(it_, code_end, code, 16);
+                if (ec != std::errc() || ptr != it_ + 4) {
+                    throw ParsingError("Invalid escape sequence \\u"s + std::string(it_, code_end));
                 }
-                ++it;
+                it_ = ptr;
+                return code;
             }
 
-            return Node(std::move(s));
-        }
+            // Appends the character of a \u escape in UTF-8. A character beyond the BMP comes as
+            // a surrogate pair of two escapes
+            void LoadUnicodeEscape(std::string& buffer) {
+                uint32_t code = ReadHexCode();
+                if (code >= 0xdc00 && code < 0xe000) {
+                    throw ParsingError("Unpaired surrogate in a \\u escape sequence"s);
+                }
+                if (code >= 0xd800 && code < 0xdc00) {
+                    if (end_ - it_ < 2 || it_[0] != '\\' || it_[1] != 'u') {
+                        throw ParsingError("Unpaired surrogate in a \\u escape sequence"s);
+                    }
+                    it_ += 2;
+                    const uint32_t low = ReadHexCode();
+                    if (low < 0xdc00 || low >= 0xe000) {
+                        throw ParsingError("Unpaired surrogate in a \\u escape sequence"s);
+                    }
+                    code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                }
 
-        Node LoadBool(std::istream& input) {
-            const auto s = LoadLiteral(input);
-            if (s == "true"sv) {
-                return Node{ true };
-            }
-            else if (s == "false"sv) {
-                return Node{ false };
+                if (code < 0x80) {
+                    buffer.push_back(static_cast<char>(code));
+                }
+                else if (code < 0x800) {
+                    buffer.push_back(static_cast<char>(0xc0 | (code >> 6)));
+                    buffer.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+                }
+                else if (code < 0x10000) {
+                    buffer.push_back(static_cast<char>(0xe0 | (code >> 12)));
+                    buffer.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+                    buffer.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+                }
+                else {
+                    buffer.push_back(static_cast<char>(0xf0 | (code >> 18)));
+                    buffer.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3f)));
+                    buffer.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+                    buffer.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+                }
             }
-            else {
-                throw ParsingError("Failed to parse '"s + s + "' as bool"s);
+
+            Result LoadBool() {
+                const auto s = LoadLiteral();
+                if (s == "true"sv) {
+                    return Result{ true };
+                }
+                else if (s == "false"sv) {
+                    return Result{ false };
+                }
+                else {
+                    throw ParsingError("Failed to parse '"s + std::string(s) + "' as bool"s);
+                }
             }
-        }
 
-        Node LoadNull(std::istream& input) {
-            if (auto literal = LoadLiteral(input); literal == "null"sv) {
-                return Node{ nullptr };
+            Result LoadNull() {
+                if (auto literal = LoadLiteral(); literal == "null"sv) {
+                    return Result{ nullptr };
+                }
+                else {
+                    throw ParsingError("Failed to parse '"s + std::string(literal) + "' as null"s);
+                }
             }
-            else {
-                throw ParsingError("Failed to parse '"s + literal + "' as null"s);
+
+            void ReadDigits() {
+                if (!IsDigit(Peek())) {
+                    throw ParsingError("A digit is expected"s);
+                }
+                while (IsDigit(Peek())) {
+                    ++it_;
+                }
             }
-        }
 
-        Node LoadNumber(std::istream& input) {
-            std::string parsed_num;
+            Result LoadNumber() {
+                const char* begin = it_;
 
-            auto read_char = [&parsed_num, &input] {
-                parsed_num += static_cast<char>(input.get());
-                if (!input) {
-                    throw ParsingError("Failed to read number from stream"s);
+                if (Peek() == '-') {
+                    ++it_;
+                }
+                if (Peek() == '0') {
+                    ++it_;
+                }
+                else {
+                    ReadDigits();
                 }
-            };
 
-            auto read_digits = [&input, read_char] {
-                if (!std::isdigit(input.peek())) {
-                    throw ParsingError("A digit is expected"s);
+                bool is_int = true;
+                // Ïàðñèì äðîáíóþ ÷àñòü ÷èñëà
+                if (Peek() == '.') {
+                    ++it_;
+                    ReadDigits();
+                    is_int = false;
                 }
-                while (std::isdigit(input.peek())) {
-                    read_char();
+
+                if (char ch = Peek(); ch == 'e' || ch == 'E') {
+                    ++it_;
+                    if (ch = Peek(); ch == '+' || ch == '-') {
+                        ++it_;
+                    }
+                    ReadDigits();
+                    is_int = false;
+                }
+
+                // Integers that don't fit into int become doubles, as stoi/stod did before
+                if (is_int) {
+                    int value = 0;
+                    if (auto [ptr, ec] = std::from_chars(begin, it_, value); ec == std::errc{}) {
+                        return Result{ value };
+                    }
                 }
-            };
 
-            if (input.peek() == '-') {
-                read_char();
+                // stod rejected subnormal results as out of range, from_chars returns them
+                double value = 0.0;
+                if (auto [ptr, ec] = std::from_chars(begin, it_, value);
+                    ec == std::errc{} && (value == 0.0 || std::abs(value) >= std::numeric_limits<double>::min())) {
+                    return Result{ value };
+                }
+                throw ParsingError("Failed to convert "s + std::string(begin, it_) + " to number"s);
             }
-            if (input.peek() == '0') {
-                read_char();
+
+            const char* it_;
+            const char* end_;
+        };
+
+        class Parser : public BasicParser<Parser, Node> {
+        public:
+            using BasicParser::BasicParser;
+
+            // Arrays at the top level, the root one or values of the root dict, are split among
+            // the pool when they are large. The elements are then parsed one by one, so an array
+            // the serial grammar reads differently, like one with missing commas, is rejected.
+            // Must not be called from a task of the same pool
+            Parser(const char* begin, const char* end, ThreadPool& thread_pool)
+                : BasicParser(begin, end)
+                , thread_pool_(&thread_pool) {
             }
-            else {
-                read_digits();
+
+        private:
+            friend BasicParser;
+
+            // Smaller arrays are not worth the scan and the tasks
+            static constexpr ptrdiff_t MIN_PARALLEL_ARRAY_SIZE = 64 * 1024;
+
+            Node LoadArray() {
+                // A single thread would only add the scan
+                if (thread_pool_ != nullptr && thread_pool_->GetThreadsCount() > 1 && depth_ <= 1) {
+                    if (auto result = LoadArrayInParallel()) {
+                        return std::move(*result);
+                    }
+                }
+
+                ++depth_;
+                std::vector<Node> result;
+
+                char c;
+                while (true) {
+                    if (!NextNonSpace(c)) {
+                        throw ParsingError("Array parsing error"s);
+                    }
+                    if (c == ']') {
+                        break;
+                    }
+                    if (c != ',') {
+                        --it_;
+                    }
+                    result.push_back(LoadNode());
+                }
+                --depth_;
+                return Node(std::move(result));
             }
 
-            bool is_int = true;
-            // Ïàðñèì äðîáíóþ ÷àñòü ÷èñëà
-            if (input.peek() == '.') {
-                read_char();
-                read_digits();
-                is_int = false;
+            // nullopt for an array below MIN_PARALLEL_ARRAY_SIZE, which is left to LoadArray
+            std::optional<Node> LoadArrayInParallel() {
+                std::vector<const char*> separators;
+                const char* close = ScanArray(it_ - 1, end_, separators);
+                if (close == nullptr || *close != ']') {
+                    throw ParsingError("Array parsing error"s);
+                }
+                if (close - it_ < MIN_PARALLEL_ARRAY_SIZE) {
+                    return std::nullopt;
+                }
+
+                // Element i lies between bounds[i] and bounds[i + 1], the separators excluded
+                std::vector<const char*> bounds;
+                bounds.reserve(separators.size() + 2);
+                bounds.push_back(it_ - 1);
+                bounds.insert(bounds.end(), separators.begin(), separators.end());
+                bounds.push_back(close);
+
+                std::vector<Node> result(bounds.size() - 1);
+                thread_pool_->ParallelFor(result.size(), [&bounds, &result](size_t first, size_t last) {
+                    for (size_t i = first; i < last; ++i) {
+                        const char* element_end = bounds[i + 1];
+                        Parser parser(bounds[i] + 1, element_end);
+                        result[i] = parser.LoadNode();
+                        if (FindNonSpace(parser.GetPosition(), element_end) != element_end) {
+                            throw ParsingError(R"(',' is expected between array elements)"s);
+                        }
+                    }
+                });
+
+                it_ = close + 1;
+                return Node(std::move(result));
             }
 
-            if (int ch = input.peek(); ch == 'e' || ch == 'E') {
-                read_char();
-                if (ch = input.peek(); ch == '+' || ch == '-') {
-                    read_char();
+            Node LoadDict() {
+                ++depth_;
+                Dict dict;
+
+                char c;
+                while (true) {
+                    if (!NextNonSpace(c)) {
+                        throw ParsingError("Dictionary parsing error"s);
+                    }
+                    if (c == '}') {
+                        break;
+                    }
+                    if (c == '"') {
+                        std::string key(ReadString(buffer_));
+                        if (NextNonSpace(c) && c == ':') {
+                            auto position = dict.lower_bound(key);
+                            if (position != dict.end() && position->first == key) {
+                                throw ParsingError("Duplicate key '"s + key + "' have been found");
+                            }
+                            Node value = LoadNode();
+                            dict.emplace_hint(position, std::move(key), std::move(value));
+                        }
+                        else {
+                            throw ParsingError(": is expected but '"s + c + "' has been found"s);
+                        }
+                    }
+                    else if (c != ',') {
+                        throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+                    }
                 }
-                read_digits();
-                is_int = false;
+                --depth_;
+                return Node(std::move(dict));
+            }
+
+            Node LoadString() {
+                return Node(std::string(ReadString(buffer_)));
             }
 
+            std::string buffer_;
+            ThreadPool* thread_pool_ = nullptr;
+            // Containers open around the value being parsed
+            int depth_ = 0;
+        };
+
+        // The split parse rejects some inputs the serial one accepts, and its errors may differ.
+        // Such inputs are parsed again serially, so the outcome is always that of Load
+        Node LoadNodeInParallel(const char* begin, const char* end, ThreadPool& thread_pool, const char*& position) {
             try {
-                if (is_int) {
-                    try {
-                        return std::stoi(parsed_num);
-                    }
-                    catch (...) {
+                Parser parser(begin, end, thread_pool);
+                Node result = parser.LoadNode();
+                position = parser.GetPosition();
+                return result;
+            }
+            catch (const ParsingError&) {
+                Parser parser(begin, end);
+                Node result = parser.LoadNode();
+                position = parser.GetPosition();
+                return result;
+            }
+        }
+
+        // Builds ArenaNodes. Elements and members of the containers being parsed are kept on shared
+        // stacks and are copied to the arena in one piece when their container closes
+        class ArenaParser : public BasicParser<ArenaParser, ArenaNode> {
+        public:
+            ArenaParser(const char* begin, const char* end, memory::MonotonicArena& arena)
+                : BasicParser(begin, end)
+                , arena_(arena) {
+            }
 
+        private:
+            friend BasicParser;
+
+            ArenaNode LoadArray() {
+                const size_t first = elements_.size();
+
+                char c;
+                while (true) {
+                    if (!NextNonSpace(c)) {
+                        throw ParsingError("Array parsing error"s);
                     }
+                    if (c == ']') {
+                        break;
+                    }
+                    if (c != ',') {
+                        --it_;
+                    }
+                    ArenaNode element = LoadNode();
+                    elements_.push_back(element);
                 }
-                return std::stod(parsed_num);
+
+                const auto items = arena_.CopyArray(elements_.data() + first, elements_.size() - first);
+                elements_.resize(first);
+                return ArenaNode(ArenaArray(items.data(), items.size()));
             }
-            catch (...) {
-                throw ParsingError("Failed to convert "s + parsed_num + " to number"s);
+
+            ArenaNode LoadDict() {
+                const size_t first = members_.size();
+
+                char c;
+                while (true) {
+                    if (!NextNonSpace(c)) {
+                        throw ParsingError("Dictionary parsing error"s);
+                    }
+                    if (c == '}') {
+                        break;
+                    }
+                    if (c == '"') {
+                        const std::string_view key = StoreString(ReadString(buffer_));
+                        if (NextNonSpace(c) && c == ':') {
+                            ArenaNode value = LoadNode();
+                            members_.push_back({ key, value });
+                        }
+                        else {
+                            throw ParsingError(": is expected but '"s + c + "' has been found"s);
+                        }
+                    }
+                    else if (c != ',') {
+                        throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+                    }
+                }
+
+                const auto begin = members_.begin() + static_cast<std::ptrdiff_t>(first);
+                std::sort(begin, members_.end(), [](const ArenaMember& lhs, const ArenaMember& rhs) {
+                    return lhs.key < rhs.key;
+                });
+                const auto duplicate = std::adjacent_find(begin, members_.end(), [](const ArenaMember& lhs, const ArenaMember& rhs) {
+                    return lhs.key == rhs.key;
+                });
+                if (duplicate != members_.end()) {
+                    throw ParsingError("Duplicate key '"s + std::string(duplicate->key) + "' have been found");
+                }
+
+                const auto members = arena_.CopyArray(members_.data() + first, members_.size() - first);
+                members_.resize(first);
+                return ArenaNode(ArenaDict(members.data(), members.size()));
             }
-        }
 
-        Node LoadNode(std::istream& input) {
-            char c;
-            if (!(input >> c)) {
-                throw ParsingError("Unexpected EOF"s);
+            ArenaNode LoadString() {
+                return ArenaNode(StoreString(ReadString(buffer_)));
             }
-            switch (c) {
-            case '[':
-                return LoadArray(input);
-            case '{':
-                return LoadDict(input);
-            case '"':
-                return LoadString(input);
-            case 't':
-                [[fallthrough]];
-            case 'f':
-                input.putback(c);
-                return LoadBool(input);
-            case 'n':
-                input.putback(c);
-                return LoadNull(input);
-            default:
-                input.putback(c);
-                return LoadNumber(input);
+
+            // Views into the input stay as they are, unescaped strings are moved out of buffer_
+            std::string_view StoreString(std::string_view str) {
+                return str.data() == buffer_.data() ? arena_.CopyString(str) : str;
             }
-        }
+
+            memory::MonotonicArena& arena_;
+            std::string buffer_;
+            std::vector<ArenaNode> elements_;
+            std::vector<ArenaMember> members_;
+        };
 
         struct PrintContext {
             std::ostream& out;
+            numbers::DoublePrecision precision = numbers::DoublePrecision::Default;
+            bool compact = false;
             int indent_step = 4;
             int indent = 0;
 
+            void PrintLineBreak() const {
+                if (!compact) {
+                    out.put('\n');
+                }
+            }
+
             void PrintIndent() const {
-                for (int i = 0; i < indent; ++i) {
-                    out.put(' ');
+                static constexpr std::string_view SPACES = "                "sv;
+                if (compact) {
+                    return;
+                }
+                for (int left = indent; left > 0; left -= static_cast<int>(SPACES.size())) {
+                    out.write(SPACES.data(), std::min(left, static_cast<int>(SPACES.size())));
                 }
             }
 
             PrintContext Indented() const {
-                return { out, indent_step, indent_step + indent };
+                return { out, precision, compact, indent_step, indent_step + indent };
             }
         };
 
@@ -243,26 +811,59 @@ namespace json {
             ctx.out << value;
         }
 
-        void PrintString(const std::string& value, std::ostream& out) {
-            out.put('"');
-            for (const char c : value) {
-                switch (c) {
+        // Passes the string to write piece by piece, escaped: runs without characters to escape
+        // go whole, as found by FindEscaped, and the escape sequences between them. Control
+        // characters without a short form are written as \u00XX
+        template <typename Write>
+        void EscapeString(std::string_view value, Write write) {
+            const char* it = value.data();
+            const char* const end = it + value.size();
+            while (true) {
+                const char* run_end = FindEscaped(it, end);
+                if (run_end != it) {
+                    write(std::string_view(it, static_cast<size_t>(run_end - it)));
+                }
+                if (run_end == end) {
+                    return;
+                }
+                switch (*run_end) {
                 case '\r':
-                    out << "\\r"sv;
+                    write("\\r"sv);
                     break;
                 case '\n':
-                    out << "\\n"sv;
+                    write("\\n"sv);
+                    break;
+                case '\t':
+                    write("\\t"sv);
+                    break;
+                case '\b':
+                    write("\\b"sv);
+                    break;
+                case '\f':
+                    write("\\f"sv);
                     break;
                 case '"':
-                    [[fallthrough]];
+                    write("\\\""sv);
+                    break;
                 case '\\':
-                    out.put('\\');
-                    [[fallthrough]];
-                default:
-                    out.put(c);
+                    write("\\\\"sv);
+                    break;
+                default: {
+                    constexpr std::string_view hex_digits = "0123456789abcdef"sv;
+                    const char code[] = { '\\', 'u', '0', '0', hex_digits[*run_end >> 4], hex_digits[*run_end & 0xf] };
+                    write(std::string_view(code, sizeof(code)));
                     break;
                 }
+                }
+                it = run_end + 1;
             }
+        }
+
+        void PrintString(std::string_view value, std::ostream& out) {
+            out.put('"');
+            EscapeString(value, [&out](std::string_view piece) {
+                out.write(piece.data(), static_cast<std::streamsize>(piece.size()));
+            });
             out.put('"');
         }
 
@@ -271,6 +872,16 @@ namespace json {
             PrintString(value, ctx.out);
         }
 
+        template <>
+        void PrintValue<int>(const int& value, const PrintContext& ctx) {
+            ctx.out << numbers::Format(value);
+        }
+
+        template <>
+        void PrintValue<double>(const double& value, const PrintContext& ctx) {
+            ctx.out << numbers::Format(value, ctx.precision);
+        }
+
         template <>
         void PrintValue<std::nullptr_t>(const std::nullptr_t&, const PrintContext& ctx) {
             ctx.out << "null"sv;
@@ -284,7 +895,8 @@ namespace json {
         template <>
         void PrintValue<Array>(const Array& nodes, const PrintContext& ctx) {
             std::ostream& out = ctx.out;
-            out << "[\n"sv;
+            out.put('[');
+            ctx.PrintLineBreak();
             bool first = true;
             auto inner_ctx = ctx.Indented();
             for (const Node& node : nodes) {
@@ -292,12 +904,13 @@ namespace json {
                     first = false;
                 }
                 else {
-                    out << ",\n"sv;
+                    out.put(',');
+                    ctx.PrintLineBreak();
                 }
                 inner_ctx.PrintIndent();
                 PrintNode(node, inner_ctx);
             }
-            out.put('\n');
+            ctx.PrintLineBreak();
             ctx.PrintIndent();
             out.put(']');
         }
@@ -305,7 +918,8 @@ namespace json {
         template <>
         void PrintValue<Dict>(const Dict& nodes, const PrintContext& ctx) {
             std::ostream& out = ctx.out;
-            out << "{\n"sv;
+            out.put('{');
+            ctx.PrintLineBreak();
             bool first = true;
             auto inner_ctx = ctx.Indented();
             for (const auto& [key, node] : nodes) {
@@ -313,14 +927,15 @@ namespace json {
                     first = false;
                 }
                 else {
-                    out << ",\n"sv;
+                    out.put(',');
+                    ctx.PrintLineBreak();
                 }
                 inner_ctx.PrintIndent();
                 PrintString(key, ctx.out);
-                out << ": "sv;
+                out << (ctx.compact ? ":"sv : ": "sv);
                 PrintNode(node, inner_ctx);
             }
-            out.put('\n');
+            ctx.PrintLineBreak();
             ctx.PrintIndent();
             out.put('}');
         }
@@ -335,12 +950,384 @@ namespace json {
 
     }  // namespace
 
+    std::string ReadText(std::istream& input) {
+
+        std::string buffer;
+        char chunk[1 << 16];
+
+        while (input.read(chunk, sizeof(chunk)) || input.gcount() > 0) {
+            buffer.append(chunk, static_cast<size_t>(input.gcount()));
+        }
+
+        return buffer;
+    }
+
     Document Load(std::istream& input) {
-        return Document{ LoadNode(input) };
+        return Load(std::string_view(ReadText(input)));
+    }
+
+    Document Load(std::string_view text) {
+        return Document{ Parser(text.data(), text.data() + text.size()).LoadNode() };
+    }
+
+    void AppendString(std::string& output, std::string_view value) {
+        output += '"';
+        EscapeString(value, [&output](std::string_view piece) {
+            output += piece;
+        });
+        output += '"';
+    }
+
+    Document Load(std::istream& input, ThreadPool& thread_pool) {
+        return Load(std::string_view(ReadText(input)), thread_pool);
+    }
+
+    Document Load(std::string_view text, ThreadPool& thread_pool) {
+        const char* position = nullptr;
+        return Document{ LoadNodeInParallel(text.data(), text.data() + text.size(), thread_pool, position) };
+    }
+
+    ArenaDict::iterator ArenaDict::find(std::string_view key) const {
+        const auto member = std::lower_bound(begin(), end(), key, [](const ArenaMember& lhs, std::string_view rhs) {
+            return lhs.key < rhs;
+        });
+        return member != end() && member->key == key ? member : end();
+    }
+
+    size_t ArenaDict::count(std::string_view key) const {
+        return find(key) == end() ? 0 : 1;
+    }
+
+    const ArenaNode& ArenaDict::at(std::string_view key) const {
+        using namespace std::literals;
+        const auto member = find(key);
+        if (member == end()) {
+            throw std::out_of_range("No key '"s + std::string(key) + "' in the dict"s);
+        }
+        return member->value;
+    }
+
+    Node ArenaNode::ToNode() const {
+        switch (type_) {
+        case Type::Bool:
+            return Node{ value_.bool_value };
+        case Type::Int:
+            return Node{ value_.int_value };
+        case Type::Double:
+            return Node{ value_.double_value };
+        case Type::String:
+            return Node{ std::string(AsString()) };
+        case Type::Array: {
+            Array array;
+            array.reserve(size_);
+            for (const ArenaNode& item : AsArray()) {
+                array.push_back(item.ToNode());
+            }
+            return Node{ std::move(array) };
+        }
+        case Type::Dict: {
+            Dict dict;
+            for (const auto& [key, value] : AsDict()) {
+                dict.emplace_hint(dict.end(), std::string(key), value.ToNode());
+            }
+            return Node{ std::move(dict) };
+        }
+        default:
+            return Node{ nullptr };
+        }
+    }
+
+    ArenaDocument LoadArena(std::istream& input) {
+        return LoadArena(ReadText(input));
+    }
+
+    ArenaDocument LoadArena(std::string text) {
+        auto arena = std::make_unique<memory::MonotonicArena>();
+        // The text gets its final address before parsing, as the string nodes point into it
+        auto text_holder = std::make_unique<std::string>(std::move(text));
+        const ArenaNode root = ArenaParser(text_holder->data(), text_holder->data() + text_holder->size(), *arena).LoadNode();
+        return ArenaDocument(std::move(text_holder), std::move(arena), root);
+    }
+
+    BufferReader::BufferReader(std::string_view text, memory::MonotonicArena& arena)
+        : text_(text)
+        , arena_(arena) {
+    }
+
+    void BufferReader::StartDict() {
+        char c;
+        if (!NextNonSpace(c) || c != '{') {
+            throw ParsingError("Dictionary is expected"s);
+        }
+    }
+
+    std::optional<std::string_view> BufferReader::NextKey() {
+        char c;
+        while (true) {
+            if (!NextNonSpace(c)) {
+                throw ParsingError("Dictionary parsing error"s);
+            }
+            if (c == '}') {
+                return std::nullopt;
+            }
+            if (c == '"') {
+                --position_;
+                const std::string_view key = ReadValue().AsString();
+                if (!NextNonSpace(c) || c != ':') {
+                    throw ParsingError(": is expected but '"s + c + "' has been found"s);
+                }
+                return key;
+            }
+            if (c != ',') {
+                throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+            }
+        }
     }
 
-    void Print(const Document& doc, std::ostream& output) {
-        PrintNode(doc.GetRoot(), PrintContext{ output });
+    void BufferReader::StartArray() {
+        char c;
+        if (!NextNonSpace(c) || c != '[') {
+            throw ParsingError("Array is expected"s);
+        }
+    }
+
+    bool BufferReader::NextElement() {
+        char c;
+        if (!NextNonSpace(c)) {
+            throw ParsingError("Array parsing error"s);
+        }
+        if (c == ']') {
+            return false;
+        }
+        if (c != ',') {
+            --position_;
+        }
+        return true;
+    }
+
+    char BufferReader::PeekValue() {
+        char c;
+        if (!NextNonSpace(c)) {
+            return '\0';
+        }
+        --position_;
+        return c;
+    }
+
+    ArenaNode BufferReader::ReadValue() {
+        ArenaParser parser(text_.data() + position_, text_.data() + text_.size(), arena_);
+        const ArenaNode value = parser.LoadNode();
+        position_ = static_cast<size_t>(parser.GetPosition() - text_.data());
+        return value;
+    }
+
+    bool BufferReader::NextNonSpace(char& c) {
+        position_ = static_cast<size_t>(FindNonSpace(text_.data() + position_, text_.data() + text_.size()) - text_.data());
+        if (position_ == text_.size()) {
+            return false;
+        }
+        c = text_[position_++];
+        return true;
+    }
+
+    void Print(const Document& doc, std::ostream& output, const PrintOptions& options) {
+        PrintNode(doc.GetRoot(), PrintContext{ output, options.double_precision, options.compact });
+    }
+
+    StreamReader::StreamReader(std::istream& input)
+        : input_(input) {
+    }
+
+    void StreamReader::StartDict() {
+        char c;
+        if (!NextNonSpace(c) || c != '{') {
+            throw ParsingError("Dictionary is expected"s);
+        }
+    }
+
+    std::optional<std::string> StreamReader::NextKey() {
+        char c;
+        while (true) {
+            if (!NextNonSpace(c)) {
+                throw ParsingError("Dictionary parsing error"s);
+            }
+            if (c == '}') {
+                return std::nullopt;
+            }
+            if (c == '"') {
+                --position_;
+                std::string key = ReadValue().AsString();
+                if (!NextNonSpace(c) || c != ':') {
+                    throw ParsingError(": is expected but '"s + c + "' has been found"s);
+                }
+                return key;
+            }
+            if (c != ',') {
+                throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+            }
+        }
+    }
+
+    void StreamReader::StartArray() {
+        char c;
+        if (!NextNonSpace(c) || c != '[') {
+            throw ParsingError("Array is expected"s);
+        }
+    }
+
+    std::optional<Node> StreamReader::NextElement() {
+        char c;
+        if (!NextNonSpace(c)) {
+            throw ParsingError("Array parsing error"s);
+        }
+        if (c == ']') {
+            return std::nullopt;
+        }
+        if (c != ',') {
+            --position_;
+        }
+        return ReadValue();
+    }
+
+    Node StreamReader::ReadValue() {
+
+        char c;
+        if (!NextNonSpace(c)) {
+            throw ParsingError("Unexpected EOF"s);
+        }
+        --position_;
+
+        const size_t value_end = FindValueEnd();
+        Parser parser(buffer_.data() + position_, buffer_.data() + value_end);
+        Node value = parser.LoadNode();
+        position_ = static_cast<size_t>(parser.GetPosition() - buffer_.data());
+
+        return value;
+    }
+
+    Node StreamReader::ReadValue(ThreadPool& thread_pool) {
+
+        char c;
+        if (!NextNonSpace(c)) {
+            throw ParsingError("Unexpected EOF"s);
+        }
+        --position_;
+
+        const size_t value_end = FindValueEnd();
+        const char* value_position = nullptr;
+        Node value = LoadNodeInParallel(buffer_.data() + position_, buffer_.data() + value_end, thread_pool, value_position);
+        position_ = static_cast<size_t>(value_position - buffer_.data());
+
+        return value;
+    }
+
+    void StreamReader::SetWaitHandler(std::function<void()> handler) {
+        wait_handler_ = std::move(handler);
+    }
+
+    bool StreamReader::NextNonSpace(char& c) {
+
+        // Everything before the current position is consumed, so it can be dropped here
+        if (position_ > CHUNK_SIZE && position_ * 2 > buffer_.size()) {
+            buffer_.erase(0, position_);
+            position_ = 0;
+        }
+
+        while (HasChar(position_) && Parser::IsSpace(buffer_[position_])) {
+            ++position_;
+        }
+        if (!HasChar(position_)) {
+            return false;
+        }
+        c = buffer_[position_++];
+        return true;
+    }
+
+    // Takes only what the stream already holds and waits just for the next character when it holds
+    // nothing, so a value is handed out as soon as its text has arrived
+    bool StreamReader::HasChar(size_t index) {
+
+        std::streambuf& input = *input_.rdbuf();
+
+        while (index >= buffer_.size()) {
+
+            std::streamsize available = input.in_avail();
+            if (available <= 0) {
+                if (wait_handler_) {
+                    wait_handler_();
+                }
+                if (input.sgetc() == std::char_traits<char>::eof()) {
+                    input_.setstate(std::ios::eofbit);
+                    return false;
+                }
+                available = std::max<std::streamsize>(input.in_avail(), 1);
+            }
+
+            char chunk[CHUNK_SIZE];
+            const std::streamsize count = input.sgetn(chunk, std::min<std::streamsize>(available, sizeof(chunk)));
+            if (count <= 0) {
+                return false;
+            }
+            buffer_.append(chunk, static_cast<size_t>(count));
+
+        }
+        return true;
+    }
+
+    // Only finds how much input the value at the current position spans; the Parser then
+    // decides whether it is valid, so malformed input fails with the usual messages
+    size_t StreamReader::FindValueEnd() {
+
+        size_t index = position_;
+        const char first = buffer_[index];
+
+        if (first == '"') {
+            for (++index; HasChar(index); ++index) {
+                const char c = buffer_[index];
+                if (c == '\\') {
+                    ++index;
+                }
+                else if (c == '"' || c == '\n' || c == '\r') {
+                    return index + 1;
+                }
+            }
+            return buffer_.size();
+        }
+
+        if (first == '[' || first == '{') {
+            size_t depth = 0;
+            bool in_string = false;
+            for (; HasChar(index); ++index) {
+                const char c = buffer_[index];
+                if (in_string) {
+                    if (c == '\\') {
+                        ++index;
+                    }
+                    else if (c == '"' || c == '\n' || c == '\r') {
+                        in_string = false;
+                    }
+                }
+                else if (c == '"') {
+                    in_string = true;
+                }
+                else if (c == '[' || c == '{') {
+                    ++depth;
+                }
+                else if ((c == ']' || c == '}') && --depth == 0) {
+                    return index + 1;
+                }
+            }
+            return buffer_.size();
+        }
+
+        // Numbers and literals: up to the next separator, at least one character
+        for (++index; HasChar(index); ++index) {
+            const char c = buffer_[index];
+            if (Parser::IsSpace(c) || c == ',' || c == ']' || c == '}' || c == ':' || c == '[' || c == '{' || c == '"') {
+                return index;
+            }
+        }
+        return buffer_.size();
     }
 
 }  // namespace json
\ No newline at end of file
@@ -1,11 +1,20 @@
 #pragma once
 
+#include "arena.h"
+#include "numbers.h"
+
+#include <functional>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
+class ThreadPool;
+
 namespace json {
 
     class Node;
@@ -33,6 +42,10 @@ namespace json {
             }
             return std::get<int>(*this);
         }
+        // The TryAs* accessors return an empty optional or nullptr instead of throwing
+        std::optional<int> TryAsInt() const {
+            return IsInt() ? std::optional<int>(std::get<int>(*this)) : std::nullopt;
+        }
 
         bool IsPureDouble() const {
             return std::holds_alternative<double>(*this);
@@ -47,6 +60,9 @@ namespace json {
             }
             return IsPureDouble() ? std::get<double>(*this) : AsInt();
         }
+        std::optional<double> TryAsDouble() const {
+            return IsDouble() ? std::optional<double>(AsDouble()) : std::nullopt;
+        }
 
         bool IsBool() const {
             return std::holds_alternative<bool>(*this);
@@ -59,6 +75,9 @@ namespace json {
 
             return std::get<bool>(*this);
         }
+        std::optional<bool> TryAsBool() const {
+            return IsBool() ? std::optional<bool>(std::get<bool>(*this)) : std::nullopt;
+        }
 
         bool IsNull() const {
             return std::holds_alternative<std::nullptr_t>(*this);
@@ -84,6 +103,9 @@ namespace json {
 
             return std::get<Array>(*this);
         }
+        const Array* TryAsArray() const {
+            return std::get_if<Array>(this);
+        }
 
         bool IsString() const {
             return std::holds_alternative<std::string>(*this);
@@ -96,6 +118,9 @@ namespace json {
 
             return std::get<std::string>(*this);
         }
+        const std::string* TryAsString() const {
+            return std::get_if<std::string>(this);
+        }
 
         bool IsDict() const {
             return std::holds_alternative<Dict>(*this);
@@ -117,6 +142,9 @@ namespace json {
 
             return std::get<Dict>(*this);
         }
+        const Dict* TryAsDict() const {
+            return std::get_if<Dict>(this);
+        }
 
         bool operator==(const Node& rhs) const {
             return GetValue() == rhs.GetValue();
@@ -153,8 +181,316 @@ namespace json {
         return !(lhs == rhs);
     }
 
+    // Reads the whole stream and parses it as one buffer
     Document Load(std::istream& input);
+    Document Load(std::string_view text);
+
+    // Same Document, and the same errors, as the serial Load. Large arrays at the top level, the
+    // root one or values of the root dict, are scanned for element bounds and the elements are
+    // parsed on the pool. Must not be called from a task of the same pool
+    Document Load(std::istream& input, ThreadPool& thread_pool);
+    Document Load(std::string_view text, ThreadPool& thread_pool);
+
+    struct PrintOptions {
+        numbers::DoublePrecision double_precision = numbers::DoublePrecision::Default;
+        // No line breaks and indentation, and no space after a key
+        bool compact = false;
+    };
+
+    void Print(const Document& doc, std::ostream& output, const PrintOptions& options = {});
+
+    // Appends value as a quoted string, escaped the way Print escapes it
+    void AppendString(std::string& output, std::string_view value);
+
+    class ArenaNode;
+    struct ArenaMember;
+
+    using ArenaArray = ranges::Span<const ArenaNode>;
+
+    // Members sorted by key, looked up by binary search like a Dict
+    class ArenaDict {
+    public:
+        using iterator = const ArenaMember*;
+
+        ArenaDict() = default;
+        ArenaDict(const ArenaMember* members, size_t size)
+            : members_(members, size) {
+        }
+
+        iterator begin() const {
+            return members_.begin();
+        }
+        iterator end() const {
+            return members_.end();
+        }
+        size_t size() const {
+            return members_.size();
+        }
+        bool empty() const {
+            return members_.empty();
+        }
+
+        iterator find(std::string_view key) const;
+        size_t count(std::string_view key) const;
+        // Throws std::out_of_range for a missing key, as Dict::at does
+        const ArenaNode& at(std::string_view key) const;
+
+    private:
+        ranges::Span<const ArenaMember> members_;
+    };
+
+    // Trivially copyable node that lives in the arena of an ArenaDocument. Strings are views
+    // into the parsed text or into the arena, containers are spans of arena memory
+    class ArenaNode {
+    public:
+        ArenaNode() = default;
+        explicit ArenaNode(std::nullptr_t) {
+        }
+        explicit ArenaNode(bool value)
+            : type_(Type::Bool) {
+            value_.bool_value = value;
+        }
+        explicit ArenaNode(int value)
+            : type_(Type::Int) {
+            value_.int_value = value;
+        }
+        explicit ArenaNode(double value)
+            : type_(Type::Double) {
+            value_.double_value = value;
+        }
+        explicit ArenaNode(std::string_view value)
+            : type_(Type::String)
+            , size_(value.size()) {
+            value_.chars = value.data();
+        }
+        explicit ArenaNode(ArenaArray value)
+            : type_(Type::Array)
+            , size_(value.size()) {
+            value_.items = value.data();
+        }
+        explicit ArenaNode(ArenaDict value)
+            : type_(Type::Dict)
+            , size_(value.size()) {
+            value_.members = value.begin();
+        }
+
+        bool IsNull() const {
+            return type_ == Type::Null;
+        }
+
+        bool IsInt() const {
+            return type_ == Type::Int;
+        }
+        int AsInt() const {
+            using namespace std::literals;
+            if (!IsInt()) {
+                throw std::logic_error("Not an int"s);
+            }
+            return value_.int_value;
+        }
+        std::optional<int> TryAsInt() const {
+            return IsInt() ? std::optional<int>(value_.int_value) : std::nullopt;
+        }
+
+        bool IsPureDouble() const {
+            return type_ == Type::Double;
+        }
+        bool IsDouble() const {
+            return IsInt() || IsPureDouble();
+        }
+        double AsDouble() const {
+            using namespace std::literals;
+            if (!IsDouble()) {
+                throw std::logic_error("Not a double"s);
+            }
+            return IsPureDouble() ? value_.double_value : value_.int_value;
+        }
+        std::optional<double> TryAsDouble() const {
+            return IsDouble() ? std::optional<double>(AsDouble()) : std::nullopt;
+        }
+
+        bool IsBool() const {
+            return type_ == Type::Bool;
+        }
+        bool AsBool() const {
+            using namespace std::literals;
+            if (!IsBool()) {
+                throw std::logic_error("Not a bool"s);
+            }
+            return value_.bool_value;
+        }
+        std::optional<bool> TryAsBool() const {
+            return IsBool() ? std::optional<bool>(value_.bool_value) : std::nullopt;
+        }
+
+        bool IsString() const {
+            return type_ == Type::String;
+        }
+        std::string_view AsString() const {
+            using namespace std::literals;
+            if (!IsString()) {
+                throw std::logic_error("Not a string"s);
+            }
+            return { value_.chars, size_ };
+        }
+        std::optional<std::string_view> TryAsString() const {
+            return IsString() ? std::optional<std::string_view>(AsString()) : std::nullopt;
+        }
+
+        bool IsArray() const {
+            return type_ == Type::Array;
+        }
+        ArenaArray AsArray() const {
+            using namespace std::literals;
+            if (!IsArray()) {
+                throw std::logic_error("Not an array"s);
+            }
+            return { value_.items, size_ };
+        }
+        std::optional<ArenaArray> TryAsArray() const {
+            return IsArray() ? std::optional<ArenaArray>(AsArray()) : std::nullopt;
+        }
+
+        bool IsDict() const {
+            return type_ == Type::Dict;
+        }
+        ArenaDict AsDict() const {
+            using namespace std::literals;
+            if (!IsDict()) {
+                throw std::logic_error("Not a dict"s);
+            }
+            return { value_.members, size_ };
+        }
+        std::optional<ArenaDict> TryAsDict() const {
+            return IsDict() ? std::optional<ArenaDict>(AsDict()) : std::nullopt;
+        }
+
+        // Deep copy for the parts of a document that are kept after it is released
+        Node ToNode() const;
+
+    private:
+        enum class Type : unsigned char {
+            Null,
+            Bool,
+            Int,
+            Double,
+            String,
+            Array,
+            Dict
+        };
+
+        Type type_ = Type::Null;
+        size_t size_ = 0;
+        union {
+            bool bool_value;
+            int int_value;
+            double double_value;
+            const char* chars;
+            const ArenaNode* items;
+            const ArenaMember* members;
+        } value_ = {};
+    };
 
-    void Print(const Document& doc, std::ostream& output);
+    struct ArenaMember {
+        std::string_view key;
+        ArenaNode value;
+    };
+
+    // Owns the parsed text and the arena with all nodes, everything is freed at once with it
+    class ArenaDocument {
+    public:
+        ArenaDocument(std::unique_ptr<const std::string> text, std::unique_ptr<memory::MonotonicArena> arena, ArenaNode root)
+            : text_(std::move(text))
+            , arena_(std::move(arena))
+            , root_(root) {
+        }
+
+        ArenaNode GetRoot() const {
+            return root_;
+        }
+
+    private:
+        // Both are held by pointer, so moving the document keeps the views into them valid
+        std::unique_ptr<const std::string> text_;
+        std::unique_ptr<memory::MonotonicArena> arena_;
+        ArenaNode root_;
+    };
+
+    // Same grammar as Load, but with a few allocations per container instead of one per node
+    ArenaDocument LoadArena(std::istream& input);
+    ArenaDocument LoadArena(std::string text);
+
+    // Reads the rest of the stream into a string
+    std::string ReadText(std::istream& input);
+
+    // Pull reader over a text held whole, the buffer counterpart of StreamReader. Values are read
+    // as ArenaNodes in the given arena, so a caller can walk the parts it knows the shape of and
+    // take any other value whole. The grammar is the same as for Load
+    class BufferReader {
+    public:
+        BufferReader(std::string_view text, memory::MonotonicArena& arena);
+
+        void StartDict();
+        // Next key of the current dict, positioned at its value; nullopt after the closing brace
+        std::optional<std::string_view> NextKey();
+
+        void StartArray();
+        // Positions at the next element of the current array; false after the closing bracket
+        bool NextElement();
+
+        // The first character of the next value, '\0' at the end of the text
+        char PeekValue();
+        ArenaNode ReadValue();
+
+        size_t GetPosition() const {
+            return position_;
+        }
+        void SetPosition(size_t position) {
+            position_ = position;
+        }
+
+    private:
+        bool NextNonSpace(char& c);
+
+        std::string_view text_;
+        memory::MonotonicArena& arena_;
+        size_t position_ = 0;
+    };
+
+    // Pull reader for inputs that should not be held whole. A dict is walked key by key and
+    // an array one element at a time, every value comes as a Node. The input is read in
+    // chunks and only the value being parsed is kept, the grammar is the same as for Load
+    class StreamReader {
+    public:
+        explicit StreamReader(std::istream& input);
+
+        void StartDict();
+        // Next key of the current dict, positioned at its value; nullopt after the closing brace
+        std::optional<std::string> NextKey();
+
+        void StartArray();
+        // nullopt after the closing bracket
+        std::optional<Node> NextElement();
+
+        Node ReadValue();
+        // Reads the value whole first, then parses it as Load with a pool does
+        Node ReadValue(ThreadPool& thread_pool);
+
+        // Called each time the reader has consumed everything that arrived and is about to wait
+        // for more input, e.g. to flush the answers to the requests read so far
+        void SetWaitHandler(std::function<void()> handler);
+
+    private:
+        static constexpr size_t CHUNK_SIZE = 1 << 16;
+
+        bool NextNonSpace(char& c);
+        bool HasChar(size_t index);
+        size_t FindValueEnd();
+
+        std::istream& input_;
+        std::string buffer_;
+        size_t position_ = 0;
+        std::function<void()> wait_handler_;
+    };
 
 }  // namespace json
\ No newline at end of file
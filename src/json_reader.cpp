@@ -8,136 +8,696 @@ namespace reading_queries {
 	using namespace transport_catalogue;
 	using namespace graph;
 
-	json::Document ReadQueries(std::istream& is) {
-		return json::Load(is);
-	}
+	namespace {
+
+		// Base or update request checked and unpacked without touching the catalogue. Names are
+		// views into the parsed document and are turned into stop ids once all stops are added
+		struct StagedStop {
+			string_view name;
+			Coordinates coordinates;
+			vector<pair<string_view, size_t>> road_distances;
+			// (stop_to_id, distance) pairs of the known stops from road_distances
+			vector<pair<size_t, size_t>> resolved_distances;
+			size_t id = 0;
+		};
+
+		struct StagedBus {
+			string_view name;
+			vector<string_view> stops;
+			BusType type = BusType::Circle;
+			vector<size_t> stop_ids;
+		};
+
+		struct StagedRequest {
+			json::ArenaNode request;
+			size_t request_index = 0;
+			variant<monostate, StagedStop, StagedBus> entity;
+			string error;
+		};
+
+		const json::ArenaNode* FindKey(const json::ArenaDict& dict, string_view key) {
+
+			auto key_it = dict.find(key);
+			return key_it == dict.end() ? nullptr : &key_it->value;
+		}
 
-	void ExecuteFillInRequests(transport_catalogue::TransportCatalogue& catalogue, const json::Dict& requests) {
-		
-		const json::Node& base_requests_node = requests.at("base_requests"s);
+		optional<string_view> FindString(const json::ArenaDict& dict, string_view key) {
 
-		const json::Array& base_requests = base_requests_node.AsArray();
+			const json::ArenaNode* node = FindKey(dict, key);
+			return node == nullptr ? nullopt : node->TryAsString();
+		}
 
-		vector<const json::Node*> stops_requests;
-		vector<const json::Node*> buses_requests;
+		void StageStop(const json::ArenaDict& request, StagedRequest& staged_request) {
 
-		SplitFillingRequests(base_requests, stops_requests, buses_requests);
+			const optional<string_view> name = FindString(request, "name"sv);
+			const json::ArenaNode* latitude = FindKey(request, "latitude"sv);
+			const json::ArenaNode* longitude = FindKey(request, "longitude"sv);
 
-		ExecuteFillStopRequests(catalogue, stops_requests);
-		ExecuteFillBusRequests(catalogue, buses_requests);
+			if (!name || latitude == nullptr || !latitude->IsDouble() || longitude == nullptr || !longitude->IsDouble()) {
+				staged_request.error = "Stop request needs a string \"name\" and numeric \"latitude\" and \"longitude\""s;
+				return;
+			}
 
-	}
-	
-	void SplitFillingRequests(const json::Array& base_requests, vector<const json::Node*>& stops_requests, vector<const json::Node*>& buses_requests) {
+			StagedStop stop;
+			stop.name = *name;
+			stop.coordinates = Coordinates{ latitude->AsDouble(), longitude->AsDouble() };
+
+			// The stop is added even when its distances are broken, only the bad ones are dropped
+			const json::ArenaNode* road_distances = FindKey(request, "road_distances"sv);
+			const optional<json::ArenaDict> distances = road_distances == nullptr ? nullopt : road_distances->TryAsDict();
+
+			if (!distances) {
+				staged_request.error = "Stop "s + string(*name) + " has no \"road_distances\" dict"s;
+			}
+			else {
+				stop.road_distances.reserve(distances->size());
+				for (const auto& [stop_to, distance] : *distances) {
+					if (auto meters = distance.TryAsInt()) {
+						stop.road_distances.emplace_back(stop_to, static_cast<size_t>(*meters));
+					}
+					else {
+						staged_request.error = "Distance from "s + string(*name) + " to "s + string(stop_to) + " is not an integer"s;
+					}
+				}
+			}
+
+			staged_request.entity = move(stop);
+		}
 
-		for (const json::Node& request : base_requests) {
+		void StageBus(const json::ArenaDict& request, StagedRequest& staged_request) {
 
-			const json::Dict& base_request = request.AsDict();
-			const string& request_type = base_request.at("type").AsString();
+			const optional<string_view> name = FindString(request, "name"sv);
+			const json::ArenaNode* stops_node = FindKey(request, "stops"sv);
+			const optional<json::ArenaArray> stops = stops_node == nullptr ? nullopt : stops_node->TryAsArray();
+			const json::ArenaNode* roundtrip_node = FindKey(request, "is_roundtrip"sv);
+			const optional<bool> is_roundtrip = roundtrip_node == nullptr ? nullopt : roundtrip_node->TryAsBool();
 
-			if (request_type == "Bus") {
-				buses_requests.push_back(&request);
+			if (!name || !stops || !is_roundtrip.has_value()) {
+				staged_request.error = "Bus request needs a string \"name\", a \"stops\" array and a bool \"is_roundtrip\""s;
+				return;
+			}
+
+			StagedBus bus;
+			bus.name = *name;
+			bus.type = *is_roundtrip ? BusType::Circle : BusType::Forward;
+			bus.stops.reserve(stops->size());
+
+			for (const json::ArenaNode& stop_node : *stops) {
+
+				const optional<string_view> stop = stop_node.TryAsString();
+
+				if (!stop) {
+					staged_request.error = "Bus "s + string(*name) + " has a stop that is not a string"s;
+					return;
+				}
+
+				bus.stops.push_back(*stop);
+			}
+
+			staged_request.entity = move(bus);
+		}
+
+		void StageRequest(StagedRequest& staged_request) {
+
+			const optional<json::ArenaDict> request = staged_request.request.TryAsDict();
+			const optional<string_view> type = request ? FindString(*request, "type"sv) : nullopt;
+
+			if (!type) {
+				staged_request.error = "Request must be a dict with a string \"type\""s;
+			}
+			else if (*type == "Bus"sv) {
+				StageBus(*request, staged_request);
 			}
 			else {
-				stops_requests.push_back(&request);
+				StageStop(*request, staged_request);
 			}
 
 		}
 
-	}
+		void ResolveStopNames(const TransportCatalogue& catalogue, StagedRequest& staged_request) {
 
-	void ExecuteFillStopRequests(transport_catalogue::TransportCatalogue& catalogue, vector<const json::Node*>& stop_requests) {
+			if (auto* stop = get_if<StagedStop>(&staged_request.entity)) {
 
-		unordered_map<string, unordered_map<string, int>> additional_stops_requests;
+				stop->resolved_distances.reserve(stop->road_distances.size());
+				for (const auto& [stop_to, distance] : stop->road_distances) {
+					// Distances to unknown stops are skipped, like SetDistanceBetweenStops does
+					if (auto stop_to_id = catalogue.TryGetStopId(stop_to)) {
+						stop->resolved_distances.emplace_back(*stop_to_id, distance);
+					}
+				}
 
-		for (const json::Node* stop_request : stop_requests) {
+			}
+			else if (auto* bus = get_if<StagedBus>(&staged_request.entity)) {
 
-			try {
-				const json::Dict& request = stop_request->AsDict();
-				const string& stop_name = request.at("name"s).AsString();
-				double latitude = request.at("latitude"s).AsDouble();
-				double longitude = request.at("longitude"s).AsDouble();
-				catalogue.AddStop(stop_name, Coordinates{ latitude, longitude });
+				bus->stop_ids.reserve(bus->stops.size());
+				for (string_view stop : bus->stops) {
 
-				const json::Dict& road_distance = request.at("road_distances"s).AsDict();
+					auto stop_id = catalogue.TryGetStopId(stop);
 
-				if (!road_distance.empty()) {
+					if (!stop_id.has_value()) {
+						staged_request.error = "Bus "s + string(bus->name) + " passes through unknown stop "s + string(stop);
+						staged_request.entity = monostate{};
+						return;
+					}
+
+					bus->stop_ids.push_back(*stop_id);
+				}
 
-					additional_stops_requests.insert({ stop_name, {} });
+			}
+
+		}
+
+		// Puts the distances in the order of a parsed dict, so that they are set in the same order
+		// as by StageStop. Returns false if a stop is given twice
+		bool SortRoadDistances(vector<pair<string_view, size_t>>& road_distances) {
+
+			const auto by_stop = [](const auto& lhs, const auto& rhs) {
+				return lhs.first < rhs.first;
+			};
+			const auto same_stop = [](const auto& lhs, const auto& rhs) {
+				return lhs.first == rhs.first;
+			};
+
+			sort(road_distances.begin(), road_distances.end(), by_stop);
+			return adjacent_find(road_distances.begin(), road_distances.end(), same_stop) == road_distances.end();
+		}
+
+		// Reads a base request field by field from the text, for the Stop and Bus shapes. On any other
+		// layout returns false, and the request is then read whole and staged by StageRequest, which
+		// also reports its errors. The reader is left at an unspecified position in that case
+		bool ReadStagedRequest(json::BufferReader& reader, StagedRequest& staged_request) {
+
+			if (reader.PeekValue() != '{') {
+				return false;
+			}
+
+			optional<string_view> type;
+			optional<string_view> name;
+			optional<double> latitude;
+			optional<double> longitude;
+			optional<bool> is_roundtrip;
+			optional<vector<pair<string_view, size_t>>> road_distances;
+			optional<vector<string_view>> stops;
+
+			// Every field is read once, a repeated key falls back to the generic error as well
+			const auto read_once = [&reader](auto& field, auto read) {
+				if (field.has_value()) {
+					return false;
+				}
+				field = read(reader.ReadValue());
+				return field.has_value();
+			};
 
-					for (const auto& [stop, node_distance] : road_distance) {
+			reader.StartDict();
 
-						unordered_map<string, int>& distances_to_stop = additional_stops_requests.at(stop_name);
-						int distance = node_distance.AsInt();
-						distances_to_stop.insert({ stop, distance });
+			while (auto key = reader.NextKey()) {
 
+				bool is_read = false;
+
+				if (*key == "type"sv || *key == "name"sv) {
+					is_read = read_once(*key == "type"sv ? type : name, [](json::ArenaNode node) {
+						return node.TryAsString();
+					});
+				}
+				else if (*key == "latitude"sv || *key == "longitude"sv) {
+					is_read = read_once(*key == "latitude"sv ? latitude : longitude, [](json::ArenaNode node) {
+						return node.TryAsDouble();
+					});
+				}
+				else if (*key == "is_roundtrip"sv) {
+					is_read = read_once(is_roundtrip, [](json::ArenaNode node) {
+						return node.TryAsBool();
+					});
+				}
+				else if (*key == "stops"sv && !stops && reader.PeekValue() == '[') {
+
+					stops.emplace();
+					reader.StartArray();
+
+					while (reader.NextElement()) {
+						const optional<string_view> stop = reader.ReadValue().TryAsString();
+						if (!stop) {
+							return false;
+						}
+						stops->push_back(*stop);
 					}
+
+					is_read = true;
 				}
+				else if (*key == "road_distances"sv && !road_distances && reader.PeekValue() == '{') {
+
+					road_distances.emplace();
+					reader.StartDict();
+
+					while (auto stop_to = reader.NextKey()) {
+						const optional<int> meters = reader.ReadValue().TryAsInt();
+						if (!meters) {
+							return false;
+						}
+						road_distances->emplace_back(*stop_to, static_cast<size_t>(*meters));
+					}
+
+					is_read = SortRoadDistances(*road_distances);
+				}
+
+				if (!is_read) {
+					return false;
+				}
+
+			}
+
+			if (!type || !name) {
+				return false;
+			}
+
+			if (*type == "Bus"sv) {
+
+				if (!stops || !is_roundtrip) {
+					return false;
+				}
+
+				StagedBus bus;
+				bus.name = *name;
+				bus.type = *is_roundtrip ? BusType::Circle : BusType::Forward;
+				bus.stops = move(*stops);
+				staged_request.entity = move(bus);
 
 			}
-			catch (json::ParsingError& rn_error) {
-				cout << rn_error.what() << endl;
+			else {
+
+				if (!latitude || !longitude || !road_distances) {
+					return false;
+				}
+
+				StagedStop stop;
+				stop.name = *name;
+				stop.coordinates = Coordinates{ *latitude, *longitude };
+				stop.road_distances = move(*road_distances);
+				staged_request.entity = move(stop);
+
 			}
-			catch (logic_error& lg_error) {
-				cout << lg_error.what() << endl;
+
+			return true;
+		}
+
+		void StageRequests(vector<StagedRequest>& staged_requests, ThreadPool& thread_pool) {
+
+			thread_pool.ParallelFor(staged_requests.size(), [&](size_t first, size_t last) {
+				for (size_t i = first; i < last; ++i) {
+					StageRequest(staged_requests[i]);
+				}
+			});
+		}
+
+		// Stops get their ids serially, then stop names of buses and road distances are resolved in
+		// parallel. Only the catalogue updates are serial
+		void LoadStagedRequests(TransportCatalogue& catalogue, vector<StagedRequest>& staged_requests, ThreadPool& thread_pool, RequestErrors& errors) {
+
+			for (StagedRequest& staged_request : staged_requests) {
+				if (auto* stop = get_if<StagedStop>(&staged_request.entity)) {
+					catalogue.AddStop(string(stop->name), stop->coordinates);
+					stop->id = catalogue.GetStopId(stop->name);
+				}
 			}
-			catch (exception& std_exp) {
-				cout << std_exp.what() << endl;
+
+			thread_pool.ParallelFor(staged_requests.size(), [&](size_t first, size_t last) {
+				for (size_t i = first; i < last; ++i) {
+					ResolveStopNames(catalogue, staged_requests[i]);
+				}
+			});
+
+			// Going backwards keeps the first distance given for a pair of stops
+			for (auto staged_it = staged_requests.rbegin(); staged_it != staged_requests.rend(); ++staged_it) {
+				if (const auto* stop = get_if<StagedStop>(&staged_it->entity)) {
+					for (const auto& [stop_to_id, distance] : stop->resolved_distances) {
+						catalogue.SetDistanceBetweenStops(stop->id, stop_to_id, distance);
+					}
+				}
 			}
-			catch (...) {
-				cout << "Unknown error"sv << endl;
+
+			for (StagedRequest& staged_request : staged_requests) {
+
+				if (const auto* bus = get_if<StagedBus>(&staged_request.entity)) {
+					catalogue.AddBus(string(bus->name), bus->stop_ids, bus->type);
+				}
+
+				if (!staged_request.error.empty()) {
+					errors.push_back({ staged_request.request_index, move(staged_request.error) });
+				}
+
 			}
 
 		}
-		
-		for (const auto& [stop_from, distances] : additional_stops_requests) {
 
-			for (const auto& [stop_to, distance] : distances) {
-				catalogue.SetDistanceBetweenStops(stop_from, stop_to, static_cast<size_t>(distance));
+		// What an update request changes: a bus or a stop by name, or the road distance from
+		// the first stop to the second one
+		enum class UpdateTarget {
+			Bus,
+			Stop,
+			Distance
+		};
+
+		using UpdateKey = tuple<UpdateTarget, string_view, string_view>;
+
+		// RemoveBus, RemoveStop or RemoveDistance, stop_to is set for distances only
+		struct RemoveRequest {
+			size_t request_index = 0;
+			UpdateTarget target = UpdateTarget::Bus;
+			string_view name;
+			string_view stop_to;
+		};
+
+		void AddChangedKeys(const StagedRequest& staged_request, vector<UpdateKey>& keys) {
+
+			if (const auto* stop = get_if<StagedStop>(&staged_request.entity)) {
+				keys.emplace_back(UpdateTarget::Stop, stop->name, ""sv);
+				for (const auto& [stop_to, distance] : stop->road_distances) {
+					keys.emplace_back(UpdateTarget::Distance, stop->name, stop_to);
+				}
+			}
+			else if (const auto* bus = get_if<StagedBus>(&staged_request.entity)) {
+				keys.emplace_back(UpdateTarget::Bus, bus->name, ""sv);
 			}
 
 		}
 
+		string DescribeKey(const UpdateKey& key) {
+
+			const auto& [target, name, stop_to] = key;
+
+			switch (target) {
+			case UpdateTarget::Bus:
+				return "Bus "s + string(name);
+			case UpdateTarget::Stop:
+				return "Stop "s + string(name);
+			default:
+				return "Distance from "s + string(name) + " to "s + string(stop_to);
+			}
+		}
+
+		// Updates are applied in groups rather than in the request order, so an entity changed by
+		// several requests would end up in a state that depends on the grouping. Every request after
+		// the first one to change something is skipped and reported instead
+		vector<bool> FindRepeatedChanges(size_t requests_count, const vector<StagedRequest>& staged_requests,
+			const vector<RemoveRequest>& remove_requests, RequestErrors& errors) {
+
+			vector<vector<UpdateKey>> keys(requests_count);
+
+			for (const StagedRequest& staged_request : staged_requests) {
+				AddChangedKeys(staged_request, keys[staged_request.request_index]);
+			}
+			for (const RemoveRequest& remove_request : remove_requests) {
+				keys[remove_request.request_index].emplace_back(remove_request.target, remove_request.name, remove_request.stop_to);
+			}
+
+			vector<bool> is_repeated(requests_count, false);
+			set<UpdateKey> changed_keys;
+
+			for (size_t i = 0; i < requests_count; ++i) {
+
+				const auto repeated_key = find_if(keys[i].begin(), keys[i].end(), [&changed_keys](const UpdateKey& key) {
+					return changed_keys.count(key) != 0;
+				});
+
+				if (repeated_key != keys[i].end()) {
+					is_repeated[i] = true;
+					errors.push_back({ i, DescribeKey(*repeated_key) + " is already changed by an earlier request of this update"s });
+					continue;
+				}
+
+				changed_keys.insert(keys[i].begin(), keys[i].end());
+			}
+
+			return is_repeated;
+		}
+
+		void SortByRequest(RequestErrors& errors) {
+
+			stable_sort(errors.begin(), errors.end(), [](const RequestError& lhs, const RequestError& rhs) {
+				return lhs.request_index < rhs.request_index;
+			});
+		}
+
+		// A dict with an int "id" and a string "type", the rest is checked while answering it
+		bool IsStatRequest(const json::Node& request) {
+
+			if (!request.IsDict()) {
+				return false;
+			}
+
+			const json::Dict& dict = request.AsDict();
+			const auto id = dict.find("id"s);
+			const auto type = dict.find("type"s);
+
+			return id != dict.end() && id->second.IsInt() && type != dict.end() && type->second.IsString();
+		}
+
+		// Top level array of responses in the format they were written in
+		class ResponsePrinter {
+		public:
+			ResponsePrinter(ostream& output, ResponseFormat format, const json::PrintOptions& print_options) :
+				printer_(format == ResponseFormat::Cbor
+					? Printer(in_place_type<cbor::ArrayPrinter>, output)
+					: Printer(in_place_type<json::ArrayPrinter>, output, print_options)) {
+
+			}
+
+			void Add(string_view serialized_response) {
+				visit([serialized_response](auto& printer) {
+					printer.Add(serialized_response);
+				}, printer_);
+			}
+
+			void Finish() {
+				visit([](auto& printer) {
+					printer.Finish();
+				}, printer_);
+			}
+
+		private:
+			using Printer = variant<json::ArrayPrinter, cbor::ArrayPrinter>;
+
+			Printer printer_;
+		};
+
+	} // namespace
+
+	json::ArenaDocument ReadQueries(std::istream& is) {
+		return json::LoadArena(is);
+	}
+
+	json::Dict ReadSettings(const json::ArenaDict& queries) {
+
+		json::Dict settings;
+
+		for (const auto& [key, value] : queries) {
+			if (key != "base_requests"sv && key != "update_requests"sv) {
+				settings.emplace_hint(settings.end(), string(key), value.ToNode());
+			}
+		}
+
+		return settings;
+	}
+
+	json::Dict ReadQueriesHeader(json::StreamReader& reader, ThreadPool& thread_pool) {
+
+		json::Dict header;
+
+		reader.StartDict();
+
+		while (auto key = reader.NextKey()) {
+
+			if (header.count(*key) != 0) {
+				throw json::ParsingError("Duplicate key '"s + *key + "' have been found");
+			}
+
+			if (*key == "stat_requests"sv && header.count("serialization_settings"s) != 0) {
+				return header;
+			}
+
+			header.emplace(move(*key), reader.ReadValue(thread_pool));
+		}
+
+		return header;
+	}
+
+	json::Dict ReadQueriesLine(std::istream& input) {
+
+		string line;
+
+		while (getline(input, line)) {
+			if (line.find_first_not_of(" \t\r"sv) != string::npos) {
+				return json::Load(line).GetRoot().AsDict();
+			}
+		}
+
+		throw json::ParsingError("Settings line is expected"s);
+	}
+
+	BaseQueries ExecuteBaseQueries(std::istream& input, transport_catalogue::TransportCatalogue& catalogue, ThreadPool& thread_pool) {
+
+		const string text = json::ReadText(input);
+		// Holds the strings that had escapes, the other ones are views into the text
+		memory::MonotonicArena arena;
+		json::BufferReader reader(text, arena);
+
+		BaseQueries queries;
+		vector<StagedRequest> staged_requests;
+		bool has_base_requests = false;
+
+		reader.StartDict();
+
+		while (auto key = reader.NextKey()) {
+
+			if (queries.settings.count(string(*key)) != 0 || (*key == "base_requests"sv && has_base_requests)) {
+				throw json::ParsingError("Duplicate key '"s + string(*key) + "' have been found");
+			}
+
+			if (*key != "base_requests"sv) {
+				queries.settings.emplace(string(*key), reader.ReadValue().ToNode());
+				continue;
+			}
+
+			has_base_requests = true;
+
+			if (reader.PeekValue() != '[') {
+				reader.ReadValue().AsArray();
+			}
+
+			reader.StartArray();
+
+			while (reader.NextElement()) {
+
+				StagedRequest staged_request;
+				staged_request.request_index = staged_requests.size();
+
+				const size_t request_position = reader.GetPosition();
+
+				if (!ReadStagedRequest(reader, staged_request)) {
+					reader.SetPosition(request_position);
+					staged_request.request = reader.ReadValue();
+					staged_request.entity = monostate{};
+					StageRequest(staged_request);
+				}
+
+				staged_requests.push_back(move(staged_request));
+			}
+
+		}
+
+		if (!has_base_requests) {
+			throw out_of_range("No key 'base_requests' in the dict"s);
+		}
+
+		UpdateCoordinatesQuantization(catalogue, queries.settings);
+
+		LoadStagedRequests(catalogue, staged_requests, thread_pool, queries.errors);
+		SortByRequest(queries.errors);
+
+		catalogue.BuildIndexes();
+
+		return queries;
 	}
 	
-	void ExecuteFillBusRequests(transport_catalogue::TransportCatalogue& catalogue, vector<const json::Node*>& bus_requests) {
+	RequestErrors ExecuteUpdateRequests(transport_catalogue::TransportCatalogue& catalogue, const json::ArenaDict& requests, ThreadPool& thread_pool) {
 
-		for (const json::Node* bus_request : bus_requests) {
+		const json::ArenaArray update_requests = requests.at("update_requests"sv).AsArray();
 
-			try {
-				const json::Dict& request = bus_request->AsDict();
-				const string& bus_name = request.at("name"s).AsString();
-				const json::Array& stops_node = request.at("stops"s).AsArray();
-				vector<string> stops_at_route;
-				stops_at_route.reserve(stops_node.size());
-				
-				for (const json::Node& stop_node : stops_node) {
-
-					const string& stop = stop_node.AsString();
-					stops_at_route.push_back(stop);
+		RequestErrors errors;
+		vector<StagedRequest> staged_requests;
+		vector<RemoveRequest> remove_requests;
+
+		for (size_t i = 0; i < update_requests.size(); ++i) {
+
+			const optional<json::ArenaDict> update_request = update_requests[i].TryAsDict();
+			const optional<string_view> request_type = update_request ? FindString(*update_request, "type"sv) : nullopt;
+
+			if (request_type && (*request_type == "RemoveBus"sv || *request_type == "RemoveStop"sv)) {
+
+				const optional<string_view> name = FindString(*update_request, "name"sv);
+
+				if (!name) {
+					errors.push_back({ i, string(*request_type) + " request needs a string \"name\""s });
+				}
+				else {
+					remove_requests.push_back({ i, *request_type == "RemoveBus"sv ? UpdateTarget::Bus : UpdateTarget::Stop, *name, ""sv });
 				}
 
-				bool is_roundtrip = request.at("is_roundtrip"s).AsBool();
-				
-				BusType route_type = is_roundtrip ? BusType::Circle : BusType::Forward;
+			}
+			else if (request_type && *request_type == "RemoveDistance"sv) {
 
-				catalogue.AddBus(bus_name, stops_at_route, route_type);
+				const optional<string_view> stop_from = FindString(*update_request, "from"sv);
+				const optional<string_view> stop_to = FindString(*update_request, "to"sv);
+
+				if (!stop_from || !stop_to) {
+					errors.push_back({ i, "RemoveDistance request needs strings \"from\" and \"to\""s });
+				}
+				else {
+					remove_requests.push_back({ i, UpdateTarget::Distance, *stop_from, *stop_to });
+				}
 
 			}
-			catch (json::ParsingError& rt_error) {
-				cout << rt_error.what() << endl;
+			else {
+
+				StagedRequest staged_request;
+				staged_request.request = update_requests[i];
+				staged_request.request_index = i;
+				staged_requests.push_back(move(staged_request));
+
 			}
-			catch (logic_error& lg_error) {
-				cout << lg_error.what() << endl;
-			} 
-			catch (exception& std_except) {
-				cout << std_except.what() << endl;
+
+		}
+
+		StageRequests(staged_requests, thread_pool);
+
+		const vector<bool> is_repeated = FindRepeatedChanges(update_requests.size(), staged_requests, remove_requests, errors);
+
+		staged_requests.erase(remove_if(staged_requests.begin(), staged_requests.end(), [&is_repeated](const StagedRequest& staged_request) {
+			return is_repeated[staged_request.request_index];
+		}), staged_requests.end());
+		remove_requests.erase(remove_if(remove_requests.begin(), remove_requests.end(), [&is_repeated](const RemoveRequest& remove_request) {
+			return is_repeated[remove_request.request_index];
+		}), remove_requests.end());
+
+		for (const RemoveRequest& remove_request : remove_requests) {
+			if (remove_request.target == UpdateTarget::Bus) {
+				catalogue.RemoveBus(remove_request.name);
+			}
+		}
+
+		LoadStagedRequests(catalogue, staged_requests, thread_pool, errors);
+
+		// Stops go last, so that buses rerouted by this update no longer hold them
+		for (const RemoveRequest& remove_request : remove_requests) {
+
+			if (remove_request.target == UpdateTarget::Distance) {
+				catalogue.RemoveDistanceBetweenStops(remove_request.name, remove_request.stop_to);
 			}
-			catch (...) {
-				cout << "Unknow error"sv << endl;
+			else if (remove_request.target == UpdateTarget::Stop) {
+
+				try {
+					catalogue.RemoveStop(remove_request.name);
+				}
+				catch (logic_error& lg_error) {
+					errors.push_back({ remove_request.request_index, lg_error.what() });
+				}
+
 			}
+
 		}
 
+		SortByRequest(errors);
+
+		catalogue.BuildIndexes();
+
+		return errors;
+	}
+
+	void PrintRequestErrors(const RequestErrors& errors, std::ostream& output) {
+
+		for (const RequestError& error : errors) {
+			output << "Request "sv << error.request_index << ": "sv << error.message << '\n';
+		}
 
 	}
 
@@ -149,6 +709,57 @@ namespace reading_queries {
 
 	}
 
+	map<string, filesystem::path> GetCityBasesPaths(const json::Dict& requests) {
+
+		const json::Dict& serialization_settings = requests.at("serialization_settings"s).AsDict();
+
+		map<string, filesystem::path> city_bases;
+
+		if (const auto file = serialization_settings.find("file"s); file != serialization_settings.end()) {
+			city_bases.emplace(""s, file->second.AsString());
+		}
+
+		if (const auto cities = serialization_settings.find("cities"s); cities != serialization_settings.end()) {
+			for (const auto& [city, path] : cities->second.AsDict()) {
+				city_bases.insert_or_assign(city, path.AsString());
+			}
+		}
+
+		return city_bases;
+
+	}
+
+	void UpdateCoordinatesQuantization(TransportCatalogue& catalogue, const json::Dict& requests) {
+
+		const json::Dict& serialization_settings = requests.at("serialization_settings"s).AsDict();
+
+		if (const auto quantize = serialization_settings.find("quantize_coordinates"s); quantize != serialization_settings.end()) {
+			catalogue.SetCoordinatesQuantized(quantize->second.AsBool());
+		}
+
+	}
+
+	size_t GetMemoryBudget(const json::Dict& requests) {
+
+		const json::Dict& serialization_settings = requests.at("serialization_settings"s).AsDict();
+
+		const auto memory_budget = serialization_settings.find("memory_budget"s);
+
+		if (memory_budget == serialization_settings.end()) {
+			return 0;
+		}
+
+		const optional<double> bytes = memory_budget->second.TryAsDouble();
+
+		// The max of size_t rounds up to a power of two as a double, so it is out of range itself
+		if (!bytes || !isfinite(*bytes) || *bytes < 0.0 || *bytes >= static_cast<double>(numeric_limits<size_t>::max())) {
+			throw invalid_argument("\"memory_budget\" must be a non-negative number of bytes that fits size_t"s);
+		}
+
+		return static_cast<size_t>(*bytes);
+
+	}
+
 	render::MapSettings GetMapCustomizer(const json::Dict& requests) {
 		return render::MapSettings(requests.at("render_settings").AsDict());
 	}
@@ -162,142 +773,443 @@ namespace reading_queries {
 		return { bus_wait_time, bus_velocity };
 	}
 
-	JSONRequestBuilder::JSONRequestBuilder(const TransportCatalogue& catalogue, MapRenderer& renderer,
-		const TransportRouter& transport_router, const RouteSettings& route_settings) :
-		catalogue_(catalogue),
-		map_renderer_(renderer),
-		transport_router_(transport_router),
-		route_settings_(route_settings) {
+	void UpdateMapCustomizer(render::MapSettings& map_customizer, const json::Dict& requests) {
 
+		if (requests.count("render_settings"s) != 0) {
+			map_customizer = GetMapCustomizer(requests);
+		}
 	}
 
+	void UpdateRouteSettings(RouteSettings& route_settings, const json::Dict& requests) {
+
+		if (requests.count("routing_settings"s) != 0) {
+			route_settings = GetRouteSettings(requests);
+		}
+	}
+
+	JSONRequestBuilder::JSONRequestBuilder(CityRegistry& city_registry, ThreadPool& thread_pool, const json::PrintOptions& print_options,
+		ResponseFormat format) :
+		city_registry_(city_registry),
+		thread_pool_(thread_pool),
+		print_options_(print_options),
+		format_(format) {
+
+	}
 
-	json::Document JSONRequestBuilder::MakeJSONResponseToRequest(const json::Dict& map_requests) {
+
+	void JSONRequestBuilder::MakeJSONResponseToRequest(const json::Dict& map_requests, std::ostream& output) const {
 
 		const json::Array& stat_requests = map_requests.at("stat_requests"s).AsArray();
 
-		json::Builder answer_builder;
-		answer_builder.StartArray();
+		vector<future<string>> responses;
+		responses.reserve(stat_requests.size());
 
 		for (const json::Node& stat_request : stat_requests) {
+			responses.push_back(thread_pool_.Submit([this, &stat_request] {
+				return MakeResponse(stat_request.AsDict());
+			}));
+		}
+
+		ResponsePrinter printer(output, format_, print_options_);
+
+		for (auto& response : responses) {
+			printer.Add(response.get());
+		}
+
+		printer.Finish();
+	}
+
+	void JSONRequestBuilder::StreamResponses(json::StreamReader& reader, std::ostream& output) const {
 
-			const json::Dict& map_stat_request = stat_request.AsDict();
+		const size_t max_in_flight = thread_pool_.GetThreadsCount() * 4;
 
-			const string& type_request = map_stat_request.at("type"s).AsString();
-			const int request_id = map_stat_request.at("id"s).AsInt();
+		deque<future<string>> responses;
+		ResponsePrinter printer(output, format_, print_options_);
 
-			answer_builder.StartDict();
+		auto print_front = [&responses, &printer] {
+			printer.Add(responses.front().get());
+			responses.pop_front();
+		};
 
-			if (type_request == "Map"s) {
-				MakeMapResponse(answer_builder);
+		// Nothing more can be read for now, so everything asked so far is answered and sent out
+		reader.SetWaitHandler([&responses, &print_front, &output] {
+			while (!responses.empty()) {
+				print_front();
 			}
-			else if (type_request == "Route"s) {
+			output.flush();
+		});
 
-				const string& route_begin = map_stat_request.at("from"s).AsString();
-				const string& route_end = map_stat_request.at("to"s).AsString();
+		reader.StartArray();
 
-				MakeRouteRequest(answer_builder, route_begin, route_end);
+		while (auto stat_request = reader.NextElement()) {
 
+			while (!responses.empty() && responses.front().wait_for(0s) == future_status::ready) {
+				print_front();
 			}
-			else {
 
-				const string& request_value = map_stat_request.at("name"s).AsString();
+			responses.push_back(thread_pool_.Submit([this, request = move(*stat_request)] {
+				return MakeResponse(request.AsDict());
+			}));
 
-				if (type_request == "Stop"s) {
-					MakeStopResponse(request_value, answer_builder);
-				}
-				else {
-					MakeBusResponse(request_value, answer_builder);
+			if (responses.size() >= max_in_flight) {
+				print_front();
+			}
+
+		}
+
+		reader.SetWaitHandler(nullptr);
+
+		while (!responses.empty()) {
+			print_front();
+		}
+
+		printer.Finish();
+	}
+
+	void JSONRequestBuilder::StreamLineResponses(std::istream& input, std::ostream& output) const {
+
+		const size_t max_in_flight = thread_pool_.GetThreadsCount() * 4;
+
+		deque<future<string>> responses;
+		string line;
+
+		auto print_front = [&responses, &output] {
+			output << responses.front().get() << '\n';
+			responses.pop_front();
+		};
+
+		while (getline(input, line)) {
+
+			if (line.find_first_not_of(" \t\r"sv) == string::npos) {
+				continue;
+			}
+
+			try {
+				responses.push_back(thread_pool_.Submit([this, request = json::Load(line)] {
+
+					const json::Node& root = request.GetRoot();
+
+					if (!IsStatRequest(root)) {
+						return MakeInvalidRequestResponse(root, "Request must be a dict with an int \"id\" and a string \"type\""sv);
+					}
+
+					// A missing key or a value of another type is a lookup that finds nothing,
+					// answered as a request for an unknown entity is. std::out_of_range is a std::logic_error too
+					try {
+						return MakeResponse(root.AsDict());
+					}
+					catch (const logic_error&) {
+						return MakeInvalidRequestResponse(root, "not found"sv);
+					}
+				}));
+			}
+			catch (const json::ParsingError&) {
+				promise<string> response;
+				response.set_value(MakeInvalidRequestResponse(json::Node(), "Request line is not valid JSON"sv));
+				responses.push_back(response.get_future());
+			}
+
+			if (responses.size() >= max_in_flight) {
+				print_front();
+			}
+
+			if (input.rdbuf()->in_avail() <= 0) {
+				while (!responses.empty()) {
+					print_front();
 				}
+				output.flush();
+			}
+
+		}
+
+		while (!responses.empty()) {
+			print_front();
+		}
+		output.flush();
+	}
+
+	string JSONRequestBuilder::MakeResponse(const json::Dict& map_stat_request) const {
+
+		string answer;
+
+		if (format_ == ResponseFormat::Cbor) {
+			cbor::Writer answer_writer(answer);
+			WriteResponse(map_stat_request, answer_writer);
+		}
+		else {
+			json::Writer answer_writer(answer, json::ArrayPrinter::ELEMENT_INDENT, print_options_);
+			WriteResponse(map_stat_request, answer_writer);
+		}
+
+		return answer;
+	}
+
+	string JSONRequestBuilder::MakeInvalidRequestResponse(const json::Node& request, string_view error_message) const {
+
+		string answer;
+		json::Writer answer_writer(answer, json::ArrayPrinter::ELEMENT_INDENT, print_options_);
+
+		answer_writer.StartDict();
+		answer_writer.Key("error_message"sv).Value(error_message);
+
+		if (request.IsDict()) {
+			const auto id = request.AsDict().find("id"s);
+			if (id != request.AsDict().end() && id->second.IsInt()) {
+				answer_writer.Key("request_id"sv).Value(id->second.AsInt());
+			}
+		}
+
+		answer_writer.EndDict();
+
+		return answer;
+	}
+
+	template <typename Writer>
+	void JSONRequestBuilder::WriteResponse(const json::Dict& map_stat_request, Writer& answer_writer) const {
+
+		const string_view type_request = map_stat_request.at("type"s).AsString();
+		const int request_id = map_stat_request.at("id"s).AsInt();
 
+		answer_writer.StartDict();
+
+		const auto city = map_stat_request.find("city"s);
+		const string_view city_name = city == map_stat_request.end() ? ""sv : string_view(city->second.AsString());
+
+		if (!city_registry_.HasCity(city_name)) {
+
+			InsertErrorToResponse(request_id, answer_writer);
+			answer_writer.EndDict();
+			return;
+
+		}
+
+		if (type_request == "ReloadBase"sv) {
+
+			try {
+				city_registry_.Reload(city_name);
+				answer_writer.Key("request_id"sv).Value(request_id);
 			}
+			catch (const BaseLoadError& error) {
+				InsertErrorToResponse(request_id, answer_writer, error.what());
+			}
+
+			answer_writer.EndDict();
+			return;
+
+		}
+
+		// The snapshot stays alive until the response is built, even if the city is reloaded or evicted
+		shared_ptr<const CatalogueSnapshot> snapshot;
+
+		try {
+			snapshot = city_registry_.Acquire(city_name);
+		}
+		catch (const BaseLoadError& error) {
+
+			InsertErrorToResponse(request_id, answer_writer, error.what());
+			answer_writer.EndDict();
+			return;
+
+		}
 
-			answer_builder.Key("request_id"s).Value(request_id);
-			answer_builder.EndDict();
+		if (type_request == "Map"sv) {
+			MakeMapResponse(*snapshot, request_id, answer_writer);
+		}
+		else if (type_request == "Route"sv) {
 
+			const string_view route_begin = map_stat_request.at("from"s).AsString();
+			const string_view route_end = map_stat_request.at("to"s).AsString();
+
+			MakeRouteRequest(*snapshot, request_id, answer_writer, route_begin, route_end);
+
+		}
+		else if (type_request == "NearestStops"sv) {
+			MakeNearestStopsResponse(*snapshot, map_stat_request, request_id, answer_writer);
 		}
+		else if (type_request == "DirectBuses"sv) {
+
+			const string_view stop_from = map_stat_request.at("from"s).AsString();
+			const string_view stop_to = map_stat_request.at("to"s).AsString();
+
+			MakeDirectBusesResponse(*snapshot, request_id, answer_writer, stop_from, stop_to);
+
+		}
+		else if (type_request == "Suggest"sv) {
+			MakeSuggestResponse(*snapshot, map_stat_request, request_id, answer_writer);
+		}
+		else {
+
+			const string_view request_value = map_stat_request.at("name"s).AsString();
 
-		answer_builder.EndArray();
-		return json::Document{answer_builder.Build()};
+			if (type_request == "Stop"sv) {
+				MakeStopResponse(*snapshot, request_value, request_id, answer_writer);
+			}
+			else {
+				MakeBusResponse(*snapshot, request_value, request_id, answer_writer);
+			}
+
+		}
+
+		answer_writer.EndDict();
 	}
 
-	void JSONRequestBuilder::MakeBusResponse(const string& bus_name, json::Builder& answer_builder) const {
+	template <typename Writer>
+	void JSONRequestBuilder::MakeBusResponse(const CatalogueSnapshot& snapshot, string_view bus_name, int request_id, Writer& answer_writer) const {
 
-		const auto bus_info = catalogue_.GetBusInformation(bus_name);
+		const auto bus_info = snapshot.GetCatalogue().GetBusInformation(bus_name);
 
 		if (bus_info.has_value()) {
 
 			const BusInformation& route = *bus_info;
-			answer_builder.Key("curvature"s).Value(route.curvature);
-			answer_builder.Key("route_length"s).Value(static_cast<int>(route.route_length));
-			answer_builder.Key("stop_count"s).Value(static_cast<int>(route.stops_count));
-			answer_builder.Key("unique_stop_count"s).Value(static_cast<int>(route.unique_stops_count));
+			answer_writer.Key("curvature"sv).Value(route.curvature);
+			answer_writer.Key("request_id"sv).Value(request_id);
+			answer_writer.Key("route_length"sv).Value(static_cast<int>(route.route_length));
+			answer_writer.Key("stop_count"sv).Value(static_cast<int>(route.stops_count));
+			answer_writer.Key("unique_stop_count"sv).Value(static_cast<int>(route.unique_stops_count));
 			return;
 		}
 
-		InsertErrorToResponse(answer_builder);
+		InsertErrorToResponse(request_id, answer_writer);
 	}
 
-	void JSONRequestBuilder::MakeStopResponse(const string& stop_name, json::Builder& answer_builder) const {
+	template <typename Writer>
+	void JSONRequestBuilder::MakeStopResponse(const CatalogueSnapshot& snapshot, string_view stop_name, int request_id, Writer& answer_writer) const {
 
-		const auto buses_by_stop = catalogue_.GetStopInformation(stop_name);
+		const auto buses_by_stop = snapshot.GetCatalogue().GetStopInformation(stop_name);
 
 		if (buses_by_stop.has_value()) {
 
-			const auto& buses = *buses_by_stop;
-			vector<json::Node> buses_list;
+			answer_writer.Key("buses"sv).StartArray();
 
-			for (const string_view& bus : buses) {
-				buses_list.push_back(json::Node{ move(string(bus)) });
+			for (const string_view& bus : *buses_by_stop) {
+				answer_writer.Value(bus);
 			}
 
-			answer_builder.Key("buses"s).Value(move(buses_list));
+			answer_writer.EndArray();
+			answer_writer.Key("request_id"sv).Value(request_id);
+			return;
+		}
+
+		InsertErrorToResponse(request_id, answer_writer);
+
+	}
+
+	template <typename Writer>
+	void JSONRequestBuilder::MakeNearestStopsResponse(const CatalogueSnapshot& snapshot, const json::Dict& request, int request_id, Writer& answer_writer) const {
+
+		Coordinates center{ request.at("latitude"s).AsDouble(), request.at("longitude"s).AsDouble() };
+		double radius = request.at("radius"s).AsDouble();
+		int max_count = request.at("count"s).AsInt();
+
+		const auto nearest_stops = snapshot.GetCatalogue().GetNearestStops(center, radius, static_cast<size_t>(max(max_count, 0)));
+
+		answer_writer.Key("request_id"sv).Value(request_id);
+		answer_writer.Key("stops"sv).StartArray();
+
+		for (const NearestStop& nearest_stop : nearest_stops) {
+
+			answer_writer.StartDict();
+			answer_writer.Key("distance"sv).Value(nearest_stop.distance);
+			answer_writer.Key("stop_name"sv).Value(nearest_stop.stop->stop_name);
+			answer_writer.EndDict();
+
+		}
+
+		answer_writer.EndArray();
+	}
+
+	template <typename Writer>
+	void JSONRequestBuilder::MakeDirectBusesResponse(const CatalogueSnapshot& snapshot, int request_id, Writer& answer_writer, string_view stop_from, string_view stop_to) const {
+
+		const auto direct_buses = snapshot.GetCatalogue().GetDirectBuses(stop_from, stop_to);
+
+		if (!direct_buses.has_value()) {
+			InsertErrorToResponse(request_id, answer_writer);
 			return;
 		}
 
-		InsertErrorToResponse(answer_builder);
+		answer_writer.Key("buses"sv).StartArray();
+
+		for (const DirectBus& direct_bus : *direct_buses) {
 
+			answer_writer.StartDict();
+			answer_writer.Key("bus"sv).Value(direct_bus.bus->bus_name);
+			answer_writer.Key("span_count"sv).Value(static_cast<int>(direct_bus.span_count));
+			answer_writer.EndDict();
+
+		}
+
+		answer_writer.EndArray();
+		answer_writer.Key("request_id"sv).Value(request_id);
+	}
+
+	template <typename Writer>
+	void JSONRequestBuilder::MakeSuggestResponse(const CatalogueSnapshot& snapshot, const json::Dict& request, int request_id, Writer& answer_writer) const {
+
+		const string_view prefix = request.at("prefix"s).AsString();
+		const size_t max_count = static_cast<size_t>(max(request.at("count"s).AsInt(), 0));
+
+		const TransportCatalogue& catalogue = snapshot.GetCatalogue();
+
+		answer_writer.Key("buses"sv).StartArray();
+		for (string_view bus_name : catalogue.SuggestBuses(prefix, max_count)) {
+			answer_writer.Value(bus_name);
+		}
+		answer_writer.EndArray();
+
+		answer_writer.Key("request_id"sv).Value(request_id);
+
+		answer_writer.Key("stops"sv).StartArray();
+		for (string_view stop_name : catalogue.SuggestStops(prefix, max_count)) {
+			answer_writer.Value(stop_name);
+		}
+		answer_writer.EndArray();
 	}
 
-	void JSONRequestBuilder::InsertErrorToResponse(json::Builder& answer_builder) const {
+	template <typename Writer>
+	void JSONRequestBuilder::InsertErrorToResponse(int request_id, Writer& answer_writer, string_view error_message) const {
 
-		answer_builder.Key("error_message"s).Value("not found"s);
+		answer_writer.Key("error_message"sv).Value(error_message);
+		answer_writer.Key("request_id"sv).Value(request_id);
 	}
 
-	void JSONRequestBuilder::MakeMapResponse(json::Builder& answer_builder) {
+	template <typename Writer>
+	void JSONRequestBuilder::MakeMapResponse(const CatalogueSnapshot& snapshot, int request_id, Writer& answer_writer) const {
 
 		ostringstream map_output(""s);
 
-		const auto& routes_to_draw = catalogue_.GetAllBuses();
+		const auto& routes_to_draw = snapshot.GetCatalogue().GetAllBuses();
 
-		map_renderer_.RenderMap(map_output, routes_to_draw);
-		answer_builder.Key("map"s).Value(map_output.str());
+		snapshot.GetRenderer().RenderMap(map_output, routes_to_draw, print_options_.double_precision);
+		answer_writer.Key("map"sv).Value(map_output.str());
+		answer_writer.Key("request_id"sv).Value(request_id);
 	}
 
-	void JSONRequestBuilder::MakeRouteRequest(json::Builder& answer_builder, const std::string& route_begin, const std::string& route_end) const {
+	template <typename Writer>
+	void JSONRequestBuilder::MakeRouteRequest(const CatalogueSnapshot& snapshot, int request_id, Writer& answer_writer, string_view route_begin, string_view route_end) const {
 
-		std::optional<size_t> vertex_ind_route_begin = catalogue_.GetStopId(route_begin);
-		std::optional<size_t> vertex_ind_route_end = catalogue_.GetStopId(route_end);
+		std::optional<size_t> vertex_ind_route_begin = snapshot.GetCatalogue().TryGetStopId(route_begin);
+		std::optional<size_t> vertex_ind_route_end = snapshot.GetCatalogue().TryGetStopId(route_end);
 
 		if (!vertex_ind_route_begin || !vertex_ind_route_end) {
 
-			InsertErrorToResponse(answer_builder);
+			InsertErrorToResponse(request_id, answer_writer);
 			return;
 
 		}
-		const auto& graph = transport_router_.GetGraph();
-		const auto& router = transport_router_.GetRouter();
+		const auto& graph = snapshot.GetRouter().GetGraph();
+		const auto& router = snapshot.GetRouter().GetRouter();
 
 		auto route_info = router.BuildRoute(*vertex_ind_route_begin, *vertex_ind_route_end);
 
 		if (!route_info) {
 
-			InsertErrorToResponse(answer_builder);
+			InsertErrorToResponse(request_id, answer_writer);
 			return;
 
 		}
 
-		answer_builder.Key("items"s).StartArray();
+		answer_writer.Key("items"sv).StartArray();
 		const std::vector<EdgeId>& route_edges = route_info->edges;
 
 		double total_time = 0.0;
@@ -305,26 +1217,27 @@ namespace reading_queries {
 		for (EdgeId edge_id : route_edges) {
 
 			const auto& edge = graph.GetEdge(edge_id);
-			auto stop_name_from = catalogue_.GetStopNameById(edge.from);
-
-			answer_builder.StartDict();
-			answer_builder.Key("stop_name"s).Value(std::string(stop_name_from));
-			answer_builder.Key("time"s).Value(route_settings_.bus_wait_time);
-			answer_builder.Key("type"s).Value("Wait"s);
-			answer_builder.EndDict();
-
-			answer_builder.StartDict();
-			answer_builder.Key("bus"s).Value(std::string(edge.weight.bus_name));
-			answer_builder.Key("span_count"s).Value(edge.weight.stop_count);
-			answer_builder.Key("time"s).Value(edge.weight.weight - static_cast<double>(route_settings_.bus_wait_time));
-			answer_builder.Key("type"s).Value("Bus"s);
-			answer_builder.EndDict();
+			auto stop_name_from = snapshot.GetCatalogue().GetStopNameById(edge.from);
+
+			answer_writer.StartDict();
+			answer_writer.Key("stop_name"sv).Value(stop_name_from);
+			answer_writer.Key("time"sv).Value(snapshot.GetRouteSettings().bus_wait_time);
+			answer_writer.Key("type"sv).Value("Wait"sv);
+			answer_writer.EndDict();
+
+			answer_writer.StartDict();
+			answer_writer.Key("bus"sv).Value(edge.weight.bus_name);
+			answer_writer.Key("span_count"sv).Value(edge.weight.stop_count);
+			answer_writer.Key("time"sv).Value(edge.weight.weight - static_cast<double>(snapshot.GetRouteSettings().bus_wait_time));
+			answer_writer.Key("type"sv).Value("Bus"sv);
+			answer_writer.EndDict();
 			total_time += edge.weight.weight;
 		}
 
-		answer_builder.EndArray();
+		answer_writer.EndArray();
 
-		answer_builder.Key("total_time"s).Value(total_time);
+		answer_writer.Key("request_id"sv).Value(request_id);
+		answer_writer.Key("total_time"sv).Value(total_time);
 	}
 
 } // namespace reading_queries
\ No newline at end of file
@@ -1,55 +1,160 @@
 #pragma once
 
+#include "catalogue_snapshot.h"
+#include "cbor.h"
+#include "city_registry.h"
+#include "thread_pool.h"
 #include "transport_router.h"
 #include "json.h"
 #include "json_builder.h"
+#include "json_writer.h"
 #include "map_renderer.h"
 #include "router.h"
 
+#include <cmath>
+#include <deque>
 #include <filesystem>
+#include <limits>
+#include <map>
+#include <set>
 #include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <variant>
 
 namespace reading_queries {
 
-	json::Document ReadQueries(std::istream& is);
+	// Reads a make_base or update_base input into an arena document, the requests are loaded
+	// straight from it
+	json::ArenaDocument ReadQueries(std::istream& is);
 
-	void ExecuteFillInRequests(transport_catalogue::TransportCatalogue& catalogue, const json::Dict& requests);
-	
-	void ExecuteFillStopRequests(transport_catalogue::TransportCatalogue& catalogue, std::vector<const json::Node*>& stop_requests);
-	
-	void ExecuteFillBusRequests(transport_catalogue::TransportCatalogue& catalogue, std::vector<const json::Node*>& bus_requests);
-	
-	void SplitFillingRequests(const json::Array& base_requests,
-									std::vector<const json::Node*>& stops_requests,
-									std::vector<const json::Node*>& buses_requests);
+	// All top level keys of the queries except base_requests and update_requests
+	json::Dict ReadSettings(const json::ArenaDict& queries);
+
+	// Reads the top level keys of a process_requests input up to "stat_requests". If
+	// "serialization_settings" came before it, returns with the reader at the stat_requests
+	// array, so that it can be answered element by element. Otherwise the whole array is
+	// read into the result like any other key, with its elements parsed on the pool
+	json::Dict ReadQueriesHeader(json::StreamReader& reader, ThreadPool& thread_pool);
+
+	// Reads the first non-empty line of a line-delimited process_requests input, a dict with
+	// the same settings as the header of a whole document
+	json::Dict ReadQueriesLine(std::istream& input);
+
+	// A request that was skipped or applied only partly, request_index is its position in the array
+	struct RequestError {
+		size_t request_index = 0;
+		std::string message;
+	};
+
+	using RequestErrors = std::vector<RequestError>;
+
+	struct BaseQueries {
+		json::Dict settings;
+		RequestErrors errors;
+	};
+
+	// Runs a make_base input in one pass over its text. Stop and Bus requests of base_requests are
+	// unpacked straight from the text by their known shapes, any other request is parsed whole
+	// and checked the generic way. The other keys become settings, and "quantize_coordinates" is
+	// applied before the stops are added. Stops get their ids serially, then stop names of buses
+	// and road distances are resolved in parallel. Broken requests are skipped and reported in
+	// the request order
+	BaseQueries ExecuteBaseQueries(std::istream& input, transport_catalogue::TransportCatalogue& catalogue, ThreadPool& thread_pool);
+
+	// Applies "update_requests" to an already filled catalogue. Stop and Bus requests have the
+	// base_requests shape and add or replace entities, RemoveBus and RemoveStop take a name,
+	// RemoveDistance takes the "from" and "to" stops of a road distance. Requests are applied in
+	// groups: bus removals, stops, buses, stop and distance removals. So that the result doesn't
+	// depend on this order, a request that changes a bus, a stop or a distance already changed by
+	// an earlier request of the update is skipped and reported
+	RequestErrors ExecuteUpdateRequests(transport_catalogue::TransportCatalogue& catalogue, const json::ArenaDict& requests, ThreadPool& thread_pool);
+
+	void PrintRequestErrors(const RequestErrors& errors, std::ostream& output);
 
 	std::filesystem::path GetSerializeSettingsPath(const json::Dict& requests);
 
+	// Bases of all served cities: "file" is the default city "", "cities" maps names to files
+	std::map<std::string, std::filesystem::path> GetCityBasesPaths(const json::Dict& requests);
+
+	// Applies the optional "quantize_coordinates" flag, which stores stops coordinates in micro-degrees
+	void UpdateCoordinatesQuantization(transport_catalogue::TransportCatalogue& catalogue, const json::Dict& requests);
+
+	// Optional "memory_budget" in bytes for the loaded cities, 0 when absent. Throws
+	// std::invalid_argument if it is not a number, negative or too large for size_t
+	size_t GetMemoryBudget(const json::Dict& requests);
+
 	render::MapSettings GetMapCustomizer(const json::Dict& requests);
 	RouteSettings GetRouteSettings(const json::Dict& requests);
+
+	void UpdateMapCustomizer(render::MapSettings& map_customizer, const json::Dict& requests);
+	void UpdateRouteSettings(RouteSettings& route_settings, const json::Dict& requests);
 	
+	// Encoding of the responses to stat_requests
+	enum class ResponseFormat {
+		Json,
+		Cbor
+	};
+
 	class JSONRequestBuilder {
 
 	public:
         
-		JSONRequestBuilder(const transport_catalogue::TransportCatalogue& catalogue, 
-			render::MapRenderer& renderer, const TransportRouter& transport_router,
-			const RouteSettings& route_settings_);
+		// print_options apply to every JSON response, the svg of map responses included
+		JSONRequestBuilder(CityRegistry& city_registry, ThreadPool& thread_pool, const json::PrintOptions& print_options = {},
+			ResponseFormat format = ResponseFormat::Json);
+
+		// Stat requests are answered concurrently on the pool, each from the snapshot of its
+		// "city" current at its start. A ReloadBase request reads the city base again and publishes
+		// it for the requests that start later. The responses are printed in the order of the requests
+		void MakeJSONResponseToRequest(const json::Dict& map_requests, std::ostream& output) const;
 
-		json::Document MakeJSONResponseToRequest(const json::Dict& map_requests);
+		// Answers the stat_requests array the reader is at while reading it. Only a bounded
+		// window of requests is in flight, responses are printed in the request order
+		void StreamResponses(json::StreamReader& reader, std::ostream& output) const;
+
+		// Answers one request per input line with one response per output line, until the end
+		// of the input. The builder should make compact JSON responses. Responses are
+		// flushed whenever no more input is buffered, so a request written to a pipe is answered
+		// without waiting for the next one, while a file is still answered in parallel.
+		// A line that is not valid JSON or not a dict with an id and a type gets an error response
+		// instead, a request that misses its keys is answered "not found"
+		void StreamLineResponses(std::istream& input, std::ostream& output) const;
 
 	private:
 
-		void MakeBusResponse(const std::string& bus_name, json::Builder& answer_builder) const;
-		void MakeStopResponse(const std::string& stop_name, json::Builder& answer_builder) const;
-		void MakeMapResponse(json::Builder& answer_builder);
-		void MakeRouteRequest(json::Builder& answer_builder, const std::string& route_begin, const std::string& route_end) const;
-		void InsertErrorToResponse(json::Builder& answer_builder) const;
+		// Serialized response, ready for json::ArrayPrinter or cbor::ArrayPrinter
+		std::string MakeResponse(const json::Dict& map_stat_request) const;
+		// JSON response to a request that can't be answered: the error message and the request id,
+		// when it can be read
+		std::string MakeInvalidRequestResponse(const json::Node& request, std::string_view error_message) const;
+
+		// Responses are written straight to a json::Writer or a cbor::Writer. Keys, request_id
+		// included, go in the sorted order Print gives to a Dict, which both writers enforce
+		template <typename Writer>
+		void WriteResponse(const json::Dict& map_stat_request, Writer& answer_writer) const;
+		template <typename Writer>
+		void MakeBusResponse(const CatalogueSnapshot& snapshot, std::string_view bus_name, int request_id, Writer& answer_writer) const;
+		template <typename Writer>
+		void MakeStopResponse(const CatalogueSnapshot& snapshot, std::string_view stop_name, int request_id, Writer& answer_writer) const;
+		template <typename Writer>
+		void MakeMapResponse(const CatalogueSnapshot& snapshot, int request_id, Writer& answer_writer) const;
+		template <typename Writer>
+		void MakeNearestStopsResponse(const CatalogueSnapshot& snapshot, const json::Dict& request, int request_id, Writer& answer_writer) const;
+		template <typename Writer>
+		void MakeDirectBusesResponse(const CatalogueSnapshot& snapshot, int request_id, Writer& answer_writer, std::string_view stop_from, std::string_view stop_to) const;
+		template <typename Writer>
+		void MakeSuggestResponse(const CatalogueSnapshot& snapshot, const json::Dict& request, int request_id, Writer& answer_writer) const;
+		template <typename Writer>
+		void MakeRouteRequest(const CatalogueSnapshot& snapshot, int request_id, Writer& answer_writer, std::string_view route_begin, std::string_view route_end) const;
+		template <typename Writer>
+		void InsertErrorToResponse(int request_id, Writer& answer_writer, std::string_view error_message = "not found") const;
 
-		const transport_catalogue::TransportCatalogue& catalogue_;
-		render::MapRenderer& map_renderer_;
-		const TransportRouter& transport_router_;
-		const RouteSettings& route_settings_;
+		CityRegistry& city_registry_;
+		ThreadPool& thread_pool_;
+		json::PrintOptions print_options_;
+		ResponseFormat format_;
 
 	};
 
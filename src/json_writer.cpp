@@ -0,0 +1,196 @@
+#include "json_writer.h"
+
+#include <stdexcept>
+
+namespace json {
+
+    using namespace std::literals;
+
+    Writer::Writer(std::string& output, int indent, const PrintOptions& options)
+        : output_(output)
+        , indent_(indent)
+        , options_(options) {
+    }
+
+    Writer& Writer::Key(std::string_view key) {
+
+        if (scopes_.empty() || !scopes_.back().is_dict) {
+            throw std::logic_error("Can't insert a key into not a dict"s);
+        }
+        if (is_key_written_) {
+            throw std::logic_error("Can't add a new key until prev key is not completed"s);
+        }
+
+        Scope& scope = scopes_.back();
+        if (!scope.is_empty) {
+            if (key <= scope.last_key) {
+                throw std::logic_error("Key '"s + std::string(key) + "' doesn't follow '"s + scope.last_key + "'"s);
+            }
+            WriteSeparator();
+        }
+        scope.is_empty = false;
+        scope.last_key = key;
+
+        WriteIndent(scopes_.size());
+        WriteString(key);
+        output_ += options_.compact ? ":"sv : ": "sv;
+        is_key_written_ = true;
+
+        return *this;
+    }
+
+    Writer& Writer::Value(std::nullptr_t) {
+        BeforeValue();
+        output_ += "null"sv;
+        return *this;
+    }
+
+    Writer& Writer::Value(bool value) {
+        BeforeValue();
+        output_ += value ? "true"sv : "false"sv;
+        return *this;
+    }
+
+    Writer& Writer::Value(int value) {
+        BeforeValue();
+        numbers::Append(output_, value);
+        return *this;
+    }
+
+    Writer& Writer::Value(double value) {
+        BeforeValue();
+        numbers::Append(output_, value, options_.double_precision);
+        return *this;
+    }
+
+    Writer& Writer::Value(std::string_view value) {
+        BeforeValue();
+        WriteString(value);
+        return *this;
+    }
+
+    Writer& Writer::Value(const char* value) {
+        return Value(std::string_view(value));
+    }
+
+    Writer& Writer::StartDict() {
+        StartScope(true, '{');
+        return *this;
+    }
+
+    Writer& Writer::StartArray() {
+        StartScope(false, '[');
+        return *this;
+    }
+
+    Writer& Writer::EndDict() {
+        EndScope(true, '}');
+        return *this;
+    }
+
+    Writer& Writer::EndArray() {
+        EndScope(false, ']');
+        return *this;
+    }
+
+    bool Writer::IsComplete() const {
+        return is_root_written_ && scopes_.empty();
+    }
+
+    void Writer::BeforeValue() {
+
+        if (scopes_.empty()) {
+            if (is_root_written_) {
+                throw std::logic_error("The root value is already written"s);
+            }
+            is_root_written_ = true;
+            return;
+        }
+
+        Scope& scope = scopes_.back();
+
+        if (scope.is_dict) {
+            if (!is_key_written_) {
+                throw std::logic_error("Can't insert a value to a dict without key"s);
+            }
+            is_key_written_ = false;
+            return;
+        }
+
+        if (!scope.is_empty) {
+            WriteSeparator();
+        }
+        scope.is_empty = false;
+        WriteIndent(scopes_.size());
+    }
+
+    void Writer::StartScope(bool is_dict, char bracket) {
+        BeforeValue();
+        output_ += bracket;
+        WriteLineBreak();
+        scopes_.push_back({ is_dict, true, {} });
+    }
+
+    void Writer::EndScope(bool is_dict, char bracket) {
+
+        if (scopes_.empty() || scopes_.back().is_dict != is_dict) {
+            throw std::logic_error(is_dict ? "Can't close not a dict"s : "Can't close not an array"s);
+        }
+        if (is_key_written_) {
+            throw std::logic_error("There is no value for the last key"s);
+        }
+
+        scopes_.pop_back();
+        WriteLineBreak();
+        WriteIndent(scopes_.size());
+        output_ += bracket;
+    }
+
+    void Writer::WriteSeparator() {
+        output_ += ',';
+        WriteLineBreak();
+    }
+
+    void Writer::WriteLineBreak() {
+        if (!options_.compact) {
+            output_ += '\n';
+        }
+    }
+
+    void Writer::WriteIndent(size_t depth) {
+        if (!options_.compact) {
+            output_.append(static_cast<size_t>(indent_) + depth * 4, ' ');
+        }
+    }
+
+    void Writer::WriteString(std::string_view value) {
+        AppendString(output_, value);
+    }
+
+    ArrayPrinter::ArrayPrinter(std::ostream& output, const PrintOptions& options)
+        : output_(output)
+        , compact_(options.compact) {
+        output_ << (compact_ ? "["sv : "[\n"sv);
+    }
+
+    void ArrayPrinter::Add(std::string_view serialized_element) {
+        static constexpr std::string_view ELEMENT_SPACES = "    "sv;
+        static_assert(ELEMENT_SPACES.size() == ELEMENT_INDENT);
+
+        if (!is_first_) {
+            output_ << (compact_ ? ","sv : ",\n"sv);
+        }
+        is_first_ = false;
+
+        if (!compact_) {
+            output_ << ELEMENT_SPACES;
+        }
+
+        output_ << serialized_element;
+    }
+
+    void ArrayPrinter::Finish() {
+        output_ << (compact_ ? "]"sv : "\n]"sv);
+    }
+
+}
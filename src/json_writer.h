@@ -0,0 +1,83 @@
+#pragma once
+
+#include "json.h"
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace json {
+
+    // Serializes straight into a string, in the same layout as Print, without building Nodes.
+    // A call that doesn't fit the current position throws std::logic_error, as with Builder.
+    // Dict keys must come in strictly increasing order, the order Print sorts them in, so the
+    // output is the same as for a built Node; a key out of order throws std::logic_error too
+    class Writer {
+    public:
+
+        // indent is the indentation of the line the root value starts on
+        explicit Writer(std::string& output, int indent = 0, const PrintOptions& options = {});
+
+        Writer& Key(std::string_view key);
+
+        Writer& Value(std::nullptr_t);
+        Writer& Value(bool value);
+        Writer& Value(int value);
+        Writer& Value(double value);
+        Writer& Value(std::string_view value);
+        Writer& Value(const char* value);
+
+        Writer& StartDict();
+        Writer& StartArray();
+        Writer& EndDict();
+        Writer& EndArray();
+
+        // True once the root value is written and all containers are closed
+        bool IsComplete() const;
+
+    private:
+
+        struct Scope {
+            bool is_dict = false;
+            bool is_empty = true;
+            std::string last_key;
+        };
+
+        void BeforeValue();
+        void StartScope(bool is_dict, char bracket);
+        void EndScope(bool is_dict, char bracket);
+        // Layout between tokens, nothing but the comma is written in compact mode
+        void WriteSeparator();
+        void WriteLineBreak();
+        void WriteIndent(size_t depth);
+        void WriteString(std::string_view value);
+
+        std::string& output_;
+        int indent_ = 0;
+        PrintOptions options_;
+        std::vector<Scope> scopes_;
+        bool is_key_written_ = false;
+        bool is_root_written_ = false;
+    };
+
+    // Prints a top level array to a stream element by element, in the layout of Print.
+    // The elements should be serialized with the same options
+    class ArrayPrinter {
+    public:
+
+        // Indentation to create the element Writers with
+        static constexpr int ELEMENT_INDENT = 4;
+
+        explicit ArrayPrinter(std::ostream& output, const PrintOptions& options = {});
+
+        void Add(std::string_view serialized_element);
+        void Finish();
+
+    private:
+        std::ostream& output_;
+        bool compact_ = false;
+        bool is_first_ = true;
+    };
+
+}
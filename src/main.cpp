@@ -1,16 +1,66 @@
+#include "cbor.h"
 #include "request_handler.h"
 #include "json_reader.h"
 #include "serialization.h"
 
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <optional>
 #include <string_view>
 #include <cassert>
 
 using namespace std::literals;
 
 void PrintUsage(std::ostream& stream = std::cerr) {
-    stream << "Usage: transport_catalogue [make_base|process_requests]\n"sv;
+    stream << "Usage: transport_catalogue [make_base|update_base|process_requests [--ndjson|--cbor] [--compact] [--shortest-doubles]]\n"sv;
+}
+
+struct ProcessOptions {
+    json::PrintOptions print;
+    // One request per input line after a settings line, one response per output line
+    bool line_delimited = false;
+    // The whole input is one CBOR item and the responses are a CBOR array
+    bool cbor = false;
+};
+
+// Options of process_requests, nullopt for an unknown option
+std::optional<ProcessOptions> ParseProcessOptions(int argc, char* argv[]) {
+    ProcessOptions options;
+    for (int i = 2; i < argc; ++i) {
+        const std::string_view option(argv[i]);
+        if (option == "--ndjson"sv) {
+            options.line_delimited = true;
+            options.print.compact = true;
+        }
+        else if (option == "--cbor"sv) {
+            options.cbor = true;
+        }
+        else if (option == "--compact"sv) {
+            options.print.compact = true;
+        }
+        else if (option == "--shortest-doubles"sv) {
+            options.print.double_precision = numbers::DoublePrecision::Shortest;
+        }
+        else {
+            return std::nullopt;
+        }
+    }
+    if (options.line_delimited && options.cbor) {
+        return std::nullopt;
+    }
+    return options;
+}
+
+// Settings of process_requests. stat_requests are included too, unless the reader is left at them
+json::Dict ReadProcessQueries(const ProcessOptions& options, json::StreamReader& reader, ThreadPool& thread_pool) {
+    if (options.line_delimited) {
+        return reading_queries::ReadQueriesLine(std::cin);
+    }
+    if (options.cbor) {
+        return cbor::Load(std::cin).GetRoot().AsDict();
+    }
+    return reading_queries::ReadQueriesHeader(reader, thread_pool);
 }
 
 int main(int argc, char* argv[]) {
@@ -20,55 +70,115 @@ int main(int argc, char* argv[]) {
     using namespace json;
     using namespace graph;
 
-    if (argc != 2) {
+    if (argc < 2) {
         PrintUsage();
         return 1;
     }
 
     const std::string_view mode(argv[1]);
 
+    if (argc != 2 && mode != "process_requests"sv) {
+        PrintUsage();
+        return 1;
+    }
+
     if (mode == "make_base"sv) {
 
-        Document queries = ReadQueries(std::cin);
         TransportCatalogue catalogue;
+        ThreadPool thread_pool;
 
-        const Dict& queries_map = queries.GetRoot().AsDict();
+        const BaseQueries queries = ExecuteBaseQueries(std::cin, catalogue, thread_pool);
+        const Dict& settings = queries.settings;
 
-        ExecuteFillInRequests(catalogue, queries_map);
+        PrintRequestErrors(queries.errors, std::cout);
 
-        render::MapSettings customizer = GetMapCustomizer(queries_map);
-        RouteSettings route_settings = GetRouteSettings(queries_map);
+        render::MapSettings customizer = GetMapCustomizer(settings);
+        RouteSettings route_settings = GetRouteSettings(settings);
 
-        std::filesystem::path path_to_save_catalogue = GetSerializeSettingsPath(queries_map);
+        std::filesystem::path path_to_save_catalogue = GetSerializeSettingsPath(settings);
         std::ofstream output(path_to_save_catalogue, std::ios::binary);
 
         SerializeBase(catalogue, route_settings, customizer, output);
 
     }
-    else if (mode == "process_requests"sv) {
+    else if (mode == "update_base"sv) {
 
-        Document queries = ReadQueries(std::cin);
-        const Dict& queries_map = queries.GetRoot().AsDict();
-        std::filesystem::path path_to_build_catalogue = GetSerializeSettingsPath(queries_map);
-        std::ifstream input(path_to_build_catalogue, std::ios::binary);
+        ArenaDocument queries = ReadQueries(std::cin);
+        const ArenaDict queries_map = queries.GetRoot().AsDict();
+        const Dict settings = ReadSettings(queries_map);
+        std::filesystem::path path_to_catalogue = GetSerializeSettingsPath(settings);
 
         TransportCatalogue catalogue;
         render::MapSettings map_customizer;
         RouteSettings route_settings;
 
-        DeserializeBase(input, catalogue, route_settings, map_customizer);
-        render::MapProjector projector(map_customizer.GetWidth(), map_customizer.GetHeight(), map_customizer.GetPadding());
-        render::MapRenderer map_renderer(map_customizer, projector);
+        {
+            std::ifstream input(path_to_catalogue, std::ios::binary);
+            if (!input || !DeserializeBase(input, catalogue, route_settings, map_customizer)) {
+                std::cerr << "Can't read the base "sv << path_to_catalogue << '\n';
+                return 1;
+            }
+        }
+
+        ThreadPool thread_pool;
+
+        UpdateCoordinatesQuantization(catalogue, settings);
+        PrintRequestErrors(ExecuteUpdateRequests(catalogue, queries_map, thread_pool), std::cout);
+        UpdateMapCustomizer(map_customizer, settings);
+        UpdateRouteSettings(route_settings, settings);
+
+        // The old base is replaced only once the new one is completely written
+        std::filesystem::path path_to_write = path_to_catalogue;
+        path_to_write += ".tmp"sv;
+
+        {
+            std::ofstream output(path_to_write, std::ios::binary);
+            SerializeBase(catalogue, route_settings, map_customizer, output);
+            output.close();
+            if (!output) {
+                std::cerr << "Can't write the base "sv << path_to_write << '\n';
+                return 1;
+            }
+        }
+
+        std::filesystem::rename(path_to_write, path_to_catalogue);
+
+    }
+    else if (mode == "process_requests"sv) {
+
+        const std::optional<ProcessOptions> options = ParseProcessOptions(argc, argv);
+        if (!options) {
+            PrintUsage();
+            return 1;
+        }
+
+        // Gives std::cin its own buffer, which tells whether more requests have arrived
+        std::ios::sync_with_stdio(false);
+
+        ThreadPool thread_pool;
+        StreamReader queries_reader(std::cin);
+        const Dict queries_map = ReadProcessQueries(*options, queries_reader, thread_pool);
 
-        TransportRouterBuilder transport_router_builder(catalogue);
-        transport_router_builder.FillGraph(route_settings);
+        size_t memory_budget = 0;
+        try {
+            memory_budget = GetMemoryBudget(queries_map);
+        }
+        catch (const std::invalid_argument& error) {
+            std::cerr << error.what() << '\n';
+            return 1;
+        }
 
-        TransportRouter transport_router = transport_router_builder.Build();
+        CityRegistry city_registry(GetCityBasesPaths(queries_map), memory_budget);
 
-        JSONRequestBuilder json_doc_builder(catalogue, map_renderer, transport_router, route_settings);
+        JSONRequestBuilder json_doc_builder(city_registry, thread_pool, options->print, options->cbor ? ResponseFormat::Cbor : ResponseFormat::Json);
         RequestHandler handler(json_doc_builder);
 
-        handler.OutRequests(queries_map, std::cout);
+        if (options->line_delimited) {
+            handler.OutLineRequests(std::cin, std::cout);
+        }
+        else {
+            handler.OutRequests(queries_reader, queries_map, std::cout);
+        }
 
     }
     else {
@@ -141,35 +141,28 @@ namespace render {
 
 	svg::Color MapSettings::GetColorByNode(const json::Node& node_color) const {
 
-		svg::Color result_color;
-
-		try {
-
-			const std::string& color_name = node_color.AsString();
-			result_color = color_name;
-			return result_color;
+		using namespace std::literals;
 
+		if (const std::string* color_name = node_color.TryAsString()) {
+			return svg::Color{ *color_name };
 		}
-		catch (...) {
 
-			const json::Array& color_description = node_color.AsArray();
+		const json::Array* color_description = node_color.TryAsArray();
 
-			size_t color_description_size = color_description.size();
-			int red = color_description[0].AsInt();
-			int green = color_description[1].AsInt();
-			int blue = color_description[2].AsInt();
+		if (color_description == nullptr || (color_description->size() != 3 && color_description->size() != 4)) {
+			throw std::logic_error("Color must be a string or an array of 3 or 4 numbers"s);
+		}
 
-			if (color_description_size == 3) {
-				result_color = std::move(svg::Rgb(red, green, blue));
-			}
-			else {
-				double opacity = color_description[3].AsDouble();
-				result_color = std::move(svg::Rgba(red, green, blue, opacity));
-			}
+		int red = (*color_description)[0].AsInt();
+		int green = (*color_description)[1].AsInt();
+		int blue = (*color_description)[2].AsInt();
 
-			return result_color;
+		if (color_description->size() == 3) {
+			return svg::Rgb(red, green, blue);
 		}
 
+		double opacity = (*color_description)[3].AsDouble();
+		return svg::Rgba(red, green, blue, opacity);
 
 	}
 
@@ -268,7 +261,14 @@ namespace render {
 
 	}
 
-	void MapRenderer::RenderMap(ostream& output, const map<std::string_view, Bus*>& buses_to_render) {
+	void MapRenderer::RenderMap(ostream& output, const map<std::string_view, Bus*>& buses_to_render, numbers::DoublePrecision precision) const {
+
+		MapRenderer frame(customizer_, projector_);
+		frame.DrawMap(output, buses_to_render, precision);
+
+	}
+
+	void MapRenderer::DrawMap(ostream& output, const map<std::string_view, Bus*>& buses_to_render, numbers::DoublePrecision precision) {
 
 		projector_.CalcCoeficients(GetAllStopList(buses_to_render));
 
@@ -280,7 +280,7 @@ namespace render {
 		RenderStopsCircles(all_stops_map);
 		RenderStopsNames(all_stops_map);
 
-		draw_doc_.Render(output);
+		draw_doc_.Render(output, precision);
 
 	}
 
@@ -391,7 +391,7 @@ namespace render {
 
 	}
 
-	void MapRenderer::BuildDirectBus(svg::Polyline& route_line, const vector<Stop*>& stops) const {
+	void MapRenderer::BuildDirectBus(svg::Polyline& route_line, ranges::Span<Stop*> stops) const {
 
 		for (const Stop* stop : stops) {
 
@@ -401,7 +401,7 @@ namespace render {
 
 	}
 
-	void MapRenderer::BuildForwardBus(svg::Polyline& route_line, const vector<Stop*>& stops) const {
+	void MapRenderer::BuildForwardBus(svg::Polyline& route_line, ranges::Span<Stop*> stops) const {
 
 		BuildDirectBus(route_line, stops);
 
@@ -416,7 +416,7 @@ namespace render {
 
 	}
 
-	void MapRenderer::BuildCircleBus(svg::Polyline& route_line, const vector<Stop*>& stops) const {
+	void MapRenderer::BuildCircleBus(svg::Polyline& route_line, ranges::Span<Stop*> stops) const {
 
 		BuildDirectBus(route_line, stops);
 	}
@@ -498,7 +498,7 @@ namespace render {
 		text_element.SetOffset(customizer_.GetStopLabelOffset());
 		text_element.SetFontSize(customizer_.GetStopLabelFontSize());
 		text_element.SetFontFamily("Verdana"s);
-		text_element.SetData(stop->stop_name);
+		text_element.SetData(string(stop->stop_name));
 
 	}
 
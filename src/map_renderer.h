@@ -122,10 +122,14 @@ namespace render {
 		MapRenderer() = default;
 		MapRenderer(MapSettings customizer, MapProjector projector);
 
-		void RenderMap(std::ostream& output, const std::map<std::string_view, Bus*>& routes_to_render);
+		// Every call draws a fresh document, the renderer itself is never modified
+		void RenderMap(std::ostream& output, const std::map<std::string_view, Bus*>& routes_to_render,
+			numbers::DoublePrecision precision = numbers::DoublePrecision::Default) const;
 
 	private:
 
+		void DrawMap(std::ostream& output, const std::map<std::string_view, Bus*>& routes_to_render, numbers::DoublePrecision precision);
+
 		void RenderBusLines(const std::map<std::string_view, Bus*>& buses_to_render);
 		void RenderBusNames(const std::map<std::string_view, Bus*>& buses_to_render);
 		void RenderStopsCircles(const std::map<std::string_view, const Stop*>& all_stops);
@@ -135,10 +139,10 @@ namespace render {
 
 		void SetBusLineProperties(svg::Polyline& bus_line, const svg::Color& color, double line_width) const;
 
-		void BuildDirectBus(svg::Polyline& bus_line, const std::vector<Stop*>& stops) const;
+		void BuildDirectBus(svg::Polyline& bus_line, ranges::Span<Stop*> stops) const;
 
-		void BuildForwardBus(svg::Polyline& bus_line, const std::vector<Stop*>& stops) const;
-		void BuildCircleBus(svg::Polyline& bus_line, const std::vector<Stop*>& stops) const;
+		void BuildForwardBus(svg::Polyline& bus_line, ranges::Span<Stop*> stops) const;
+		void BuildCircleBus(svg::Polyline& bus_line, ranges::Span<Stop*> stops) const;
 
 		svg::Text CreateBusUnderlayer(const Stop* stop, std::string_view bus_name) const;
 		svg::Text CreateBusName(const Stop* stop, const svg::Color& color, std::string_view bus_name) const;
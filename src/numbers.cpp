@@ -0,0 +1,59 @@
+#include "numbers.h"
+
+#include <charconv>
+#include <cmath>
+
+namespace numbers {
+
+    namespace {
+
+        constexpr int DEFAULT_SIGNIFICANT_DIGITS = 6;
+
+        // Integral values that %g writes without exponent and fraction
+        constexpr double MAX_PLAIN_INTEGRAL = 1e6;
+
+    }  // namespace
+
+    char* ToChars(char* first, int value) {
+        return std::to_chars(first, first + MAX_LENGTH, value).ptr;
+    }
+
+    char* ToChars(char* first, double value, DoublePrecision precision) {
+
+        if (precision == DoublePrecision::Shortest) {
+            return std::to_chars(first, first + MAX_LENGTH, value).ptr;
+        }
+
+        // Coordinates, widths and times are mostly small whole numbers, which print as ints.
+        // Zero goes the long way so that -0 keeps its sign
+        if (value != 0.0 && std::abs(value) < MAX_PLAIN_INTEGRAL) {
+            const int integral = static_cast<int>(value);
+            if (integral == value) {
+                return ToChars(first, integral);
+            }
+        }
+
+        return std::to_chars(first, first + MAX_LENGTH, value, std::chars_format::general, DEFAULT_SIGNIFICANT_DIGITS).ptr;
+    }
+
+    void Append(std::string& output, int value) {
+        char buffer[MAX_LENGTH];
+        output.append(buffer, ToChars(buffer, value));
+    }
+
+    void Append(std::string& output, double value, DoublePrecision precision) {
+        char buffer[MAX_LENGTH];
+        output.append(buffer, ToChars(buffer, value, precision));
+    }
+
+    std::ostream& operator<<(std::ostream& out, FormattedInt number) {
+        char buffer[MAX_LENGTH];
+        return out.write(buffer, ToChars(buffer, number.value) - buffer);
+    }
+
+    std::ostream& operator<<(std::ostream& out, FormattedDouble number) {
+        char buffer[MAX_LENGTH];
+        return out.write(buffer, ToChars(buffer, number.value, number.precision) - buffer);
+    }
+
+}  // namespace numbers
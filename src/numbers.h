@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+namespace numbers {
+
+    enum class DoublePrecision {
+        // %g with 6 significant digits, the text std::ostream writes with default flags
+        Default,
+        // The shortest text that reads back as the same double
+        Shortest
+    };
+
+    // Enough for any int and for a double in either precision
+    constexpr size_t MAX_LENGTH = 32;
+
+    // Write the text to [first, first + MAX_LENGTH) and return its end
+    char* ToChars(char* first, int value);
+    char* ToChars(char* first, double value, DoublePrecision precision = DoublePrecision::Default);
+
+    void Append(std::string& output, int value);
+    void Append(std::string& output, double value, DoublePrecision precision = DoublePrecision::Default);
+
+    struct FormattedInt {
+        int value;
+    };
+
+    struct FormattedDouble {
+        double value;
+        DoublePrecision precision;
+    };
+
+    // out << Format(value) writes the same text as out << value with default flags,
+    // without going through the locale facets of the stream
+    inline FormattedInt Format(int value) {
+        return { value };
+    }
+
+    inline FormattedDouble Format(double value, DoublePrecision precision = DoublePrecision::Default) {
+        return { value, precision };
+    }
+
+    std::ostream& operator<<(std::ostream& out, FormattedInt number);
+    std::ostream& operator<<(std::ostream& out, FormattedDouble number);
+
+}  // namespace numbers
@@ -0,0 +1,31 @@
+#include "prefix_index.h"
+
+#include <algorithm>
+
+namespace transport_catalogue {
+
+    NamesPrefixIndex::NamesPrefixIndex(std::vector<std::string_view> names) :
+        names_(std::move(names)) {
+
+        std::sort(names_.begin(), names_.end());
+    }
+
+    std::vector<std::string_view> NamesPrefixIndex::FindByPrefix(std::string_view prefix, size_t max_count) const {
+
+        std::vector<std::string_view> result;
+
+        auto name_it = std::lower_bound(names_.begin(), names_.end(), prefix);
+
+        for (; name_it != names_.end() && result.size() < max_count; ++name_it) {
+
+            if (name_it->substr(0, prefix.size()) != prefix) {
+                break;
+            }
+
+            result.push_back(*name_it);
+        }
+
+        return result;
+    }
+
+} // namespace transport_catalogue
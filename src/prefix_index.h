@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+namespace transport_catalogue {
+
+    // Names sorted bytewise, so all names sharing a prefix form one contiguous range
+    // found by binary search. The names are views into the catalogue storage.
+    class NamesPrefixIndex {
+
+    public:
+
+        NamesPrefixIndex() = default;
+        explicit NamesPrefixIndex(std::vector<std::string_view> names);
+
+        // At most max_count names starting with prefix, in lexicographic order
+        std::vector<std::string_view> FindByPrefix(std::string_view prefix, size_t max_count) const;
+
+    private:
+
+        std::vector<std::string_view> names_;
+
+    };
+
+} // namespace transport_catalogue
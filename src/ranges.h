@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <iterator>
 #include <string_view>
 #include <unordered_map>
@@ -33,4 +34,55 @@ namespace ranges {
         return Range{ container.begin(), container.end() };
     }
 
+    // Non-owning view over a contiguous array
+    template <typename T>
+    class Span {
+    public:
+        using iterator = T*;
+        using reverse_iterator = std::reverse_iterator<T*>;
+
+        Span() = default;
+        Span(T* data, size_t size)
+            : data_(data)
+            , size_(size) {
+        }
+
+        T* begin() const {
+            return data_;
+        }
+        T* end() const {
+            return data_ + size_;
+        }
+        reverse_iterator rbegin() const {
+            return reverse_iterator(end());
+        }
+        reverse_iterator rend() const {
+            return reverse_iterator(begin());
+        }
+
+        T* data() const {
+            return data_;
+        }
+        size_t size() const {
+            return size_;
+        }
+        bool empty() const {
+            return size_ == 0;
+        }
+
+        T& operator[](size_t index) const {
+            return data_[index];
+        }
+        T& front() const {
+            return data_[0];
+        }
+        T& back() const {
+            return data_[size_ - 1];
+        }
+
+    private:
+        T* data_ = nullptr;
+        size_t size_ = 0;
+    };
+
 }  // namespace ranges
\ No newline at end of file
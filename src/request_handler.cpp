@@ -2,7 +2,7 @@
 
 using namespace reading_queries;
 
-RequestHandler::RequestHandler(JSONRequestBuilder& request_responder)
+RequestHandler::RequestHandler(const JSONRequestBuilder& request_responder)
 	: request_responder_(request_responder) {
 
 }
@@ -10,6 +10,29 @@ RequestHandler::RequestHandler(JSONRequestBuilder& request_responder)
 
 void RequestHandler::OutRequests(const json::Dict& map_requests, std::ostream& output) const {
 
-	Print(request_responder_.MakeJSONResponseToRequest(map_requests), output);
+	request_responder_.MakeJSONResponseToRequest(map_requests, output);
+
+}
+
+void RequestHandler::OutRequests(json::StreamReader& reader, const json::Dict& header, std::ostream& output) const {
+
+	using namespace std::literals;
+
+	if (header.count("stat_requests"s) != 0) {
+		OutRequests(header, output);
+		return;
+	}
+
+	request_responder_.StreamResponses(reader, output);
+
+	while (reader.NextKey()) {
+		reader.ReadValue();
+	}
+
+}
+
+void RequestHandler::OutLineRequests(std::istream& input, std::ostream& output) const {
+
+	request_responder_.StreamLineResponses(input, output);
 
 }
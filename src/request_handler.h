@@ -7,10 +7,15 @@ class RequestHandler {
 
 public:
 	
-	RequestHandler(reading_queries::JSONRequestBuilder& request_responder);
+	RequestHandler(const reading_queries::JSONRequestBuilder& request_responder);
 	void OutRequests(const json::Dict& map_requests, std::ostream& output) const;
+	// Answers stat_requests of a header from ReadQueriesHeader, streaming them from the reader
+	// when the header doesn't hold them, then reads the rest of the input
+	void OutRequests(json::StreamReader& reader, const json::Dict& header, std::ostream& output) const;
+	// Answers the request lines that follow a header from ReadQueriesLine
+	void OutLineRequests(std::istream& input, std::ostream& output) const;
 
 private:
 
-	reading_queries::JSONRequestBuilder& request_responder_;
+	const reading_queries::JSONRequestBuilder& request_responder_;
 };
@@ -39,12 +39,22 @@ void SerializeTransportCatalogue(transport_system::TransportCatalogue& catalogue
 
 void SerializeStops(transport_system::TransportCatalogue& catalogue_to_save, const TransportCatalogue& catalogue) {
 
+    const bool is_quantized = catalogue.IsCoordinatesQuantized();
+    catalogue_to_save.set_quantized_coordinates(is_quantized);
+
     const auto& all_stops = catalogue.GetAllStops();
-    for (const auto& stop : all_stops) {
+    for (const Stop* stop : all_stops) {
         auto* new_stop = catalogue_to_save.add_stop();
-        new_stop->set_name(stop.stop_name);
-        new_stop->set_latitude(stop.coordinates.lat);
-        new_stop->set_longitude(stop.coordinates.lng);
+        new_stop->set_name(std::string(stop->stop_name));
+        if (is_quantized) {
+            geo::QuantizedCoordinates coordinates = geo::Quantize(stop->coordinates);
+            new_stop->set_latitude_e6(coordinates.lat_e6);
+            new_stop->set_longitude_e6(coordinates.lng_e6);
+        }
+        else {
+            new_stop->set_latitude(stop->coordinates.lat);
+            new_stop->set_longitude(stop->coordinates.lng);
+        }
     }
 
 }
@@ -147,9 +157,11 @@ transport_system::Color GetSerializedColor(svg::Color color_to_serialize) {
     return serialized_color;
 }
 
-void DeserializeBase(std::istream& input, TransportCatalogue& catalogue, RouteSettings& route_settings, render::MapSettings& map_customizer) {
+bool DeserializeBase(std::istream& input, TransportCatalogue& catalogue, RouteSettings& route_settings, render::MapSettings& map_customizer) {
     transport_system::TransportCatalogue catalogue_to_read;
-    catalogue_to_read.ParseFromIstream(&input);
+    if (!catalogue_to_read.ParseFromIstream(&input)) {
+        return false;
+    }
 
     //  
     DeserializeTransportCatalogue(catalogue, catalogue_to_read);
@@ -160,6 +172,7 @@ void DeserializeBase(std::istream& input, TransportCatalogue& catalogue, RouteSe
     //   
     DeserializeRenderSettings(map_customizer, catalogue_to_read);
 
+    return true;
 }
 
 void DeserializeTransportCatalogue(TransportCatalogue& catalogue, const transport_system::TransportCatalogue& catalogue_to_read) {
@@ -173,13 +186,23 @@ void DeserializeTransportCatalogue(TransportCatalogue& catalogue, const transpor
     // ,   
     DeserializeDistancesBetweenStops(catalogue, catalogue_to_read);
 
+    catalogue.BuildIndexes();
+
 }
 
 void DeserializeStops(TransportCatalogue& catalogue, const transport_system::TransportCatalogue& catalogue_to_read) {
 
+    const bool is_quantized = catalogue_to_read.quantized_coordinates();
+    catalogue.SetCoordinatesQuantized(is_quantized);
+
     for (int i = 0; i < catalogue_to_read.stop_size(); ++i) {
         auto& stop = catalogue_to_read.stop(i);
-        catalogue.AddStop(stop.name(), { stop.latitude(), stop.longitude() });
+        if (is_quantized) {
+            catalogue.AddStop(stop.name(), geo::Dequantize({ stop.latitude_e6(), stop.longitude_e6() }));
+        }
+        else {
+            catalogue.AddStop(stop.name(), { stop.latitude(), stop.longitude() });
+        }
     }
 
 }
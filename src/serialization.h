@@ -19,7 +19,8 @@ void SerializeRenderSettings(transport_system::TransportCatalogue& catalogue_to_
 
 transport_system::Color GetSerializedColor(svg::Color color_to_serialize);
 
-void DeserializeBase(std::istream& input, transport_catalogue::TransportCatalogue& catalogue, RouteSettings& route_settings, render::MapSettings& map_customizer);
+// False if the input is not a serialized base, the outputs are left untouched then
+bool DeserializeBase(std::istream& input, transport_catalogue::TransportCatalogue& catalogue, RouteSettings& route_settings, render::MapSettings& map_customizer);
 void DeserializeTransportCatalogue(transport_catalogue::TransportCatalogue& catalogue, const transport_system::TransportCatalogue& catalogue_to_read);
 void DeserializeStops(transport_catalogue::TransportCatalogue& catalogue, const transport_system::TransportCatalogue& catalogue_to_read);
 void DeserializeBuses(transport_catalogue::TransportCatalogue& catalogue, const transport_system::TransportCatalogue& catalogue_to_read);
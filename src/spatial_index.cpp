@@ -0,0 +1,159 @@
+#include "spatial_index.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace transport_catalogue {
+
+    namespace {
+
+        const double METERS_PER_DEGREE = 6371000.0 * 3.1415926535 / 180.0;
+
+        double CalcCellSize(double min_coordinate, double max_coordinate, size_t cells_count) {
+
+            double extent = max_coordinate - min_coordinate;
+
+            if (extent <= 0.0) {
+                return 1.0;
+            }
+
+            return extent / static_cast<double>(cells_count);
+        }
+
+    } // namespace
+
+    StopsSpatialIndex::StopsSpatialIndex(const std::vector<Stop*>& stops, const geo::CoordinatesColumns& coordinates) {
+
+        if (stops.empty()) {
+            return;
+        }
+
+        double min_lat = coordinates.GetLat(0);
+        double max_lat = min_lat;
+        double min_lng = coordinates.GetLng(0);
+        double max_lng = min_lng;
+
+        for (size_t i = 1; i < stops.size(); ++i) {
+            min_lat = std::min(min_lat, coordinates.GetLat(i));
+            max_lat = std::max(max_lat, coordinates.GetLat(i));
+            min_lng = std::min(min_lng, coordinates.GetLng(i));
+            max_lng = std::max(max_lng, coordinates.GetLng(i));
+        }
+
+        // About one stop per cell on average
+        size_t side = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(stops.size()))));
+
+        rows_ = side;
+        columns_ = side;
+        min_lat_ = min_lat;
+        min_lng_ = min_lng;
+        cell_lat_size_ = CalcCellSize(min_lat_, max_lat, rows_);
+        cell_lng_size_ = CalcCellSize(min_lng_, max_lng, columns_);
+
+        std::vector<size_t> stops_cells;
+        stops_cells.reserve(stops.size());
+        cell_offsets_.assign(rows_ * columns_ + 1, 0);
+
+        for (size_t i = 0; i < stops.size(); ++i) {
+            size_t cell = GetRow(coordinates.GetLat(i)) * columns_ + GetColumn(coordinates.GetLng(i));
+            stops_cells.push_back(cell);
+            ++cell_offsets_[cell + 1];
+        }
+
+        for (size_t i = 1; i < cell_offsets_.size(); ++i) {
+            cell_offsets_[i] += cell_offsets_[i - 1];
+        }
+
+        cell_stops_.resize(stops.size());
+        std::vector<size_t> cell_stops_indexes(stops.size());
+        std::vector<size_t> cell_fill(cell_offsets_.begin(), cell_offsets_.end() - 1);
+
+        for (size_t i = 0; i < stops.size(); ++i) {
+            size_t position = cell_fill[stops_cells[i]]++;
+            cell_stops_[position] = stops[i];
+            cell_stops_indexes[position] = i;
+        }
+
+        cell_coordinates_.Reserve(cell_stops_.size());
+        for (size_t stop_index : cell_stops_indexes) {
+            cell_coordinates_.Add(coordinates.Get(stop_index));
+        }
+
+    }
+
+    std::vector<NearestStop> StopsSpatialIndex::FindNearestStops(geo::Coordinates center, double radius, size_t max_count) const {
+
+        std::vector<NearestStop> result;
+
+        if (cell_stops_.empty() || max_count == 0 || radius < 0.0) {
+            return result;
+        }
+
+        double lat_delta = radius / METERS_PER_DEGREE;
+        double farthest_lat = std::min(std::abs(center.lat) + lat_delta, 89.9);
+        double lng_delta = lat_delta / std::cos(farthest_lat * 3.1415926535 / 180.0);
+
+        double max_lat = min_lat_ + cell_lat_size_ * static_cast<double>(rows_);
+        double max_lng = min_lng_ + cell_lng_size_ * static_cast<double>(columns_);
+
+        if (center.lat + lat_delta < min_lat_ || center.lat - lat_delta > max_lat
+            || center.lng + lng_delta < min_lng_ || center.lng - lng_delta > max_lng) {
+            return result;
+        }
+
+        size_t row_from = GetRow(center.lat - lat_delta);
+        size_t row_to = GetRow(center.lat + lat_delta);
+        size_t column_from = GetColumn(center.lng - lng_delta);
+        size_t column_to = GetColumn(center.lng + lng_delta);
+
+        std::vector<double> distances;
+
+        for (size_t row = row_from; row <= row_to; ++row) {
+
+            size_t first = cell_offsets_[row * columns_ + column_from];
+            size_t last = cell_offsets_[row * columns_ + column_to + 1];
+
+            distances.resize(last - first);
+            geo::ComputeDistances(center, cell_coordinates_, first, last, distances.data());
+
+            for (size_t i = first; i < last; ++i) {
+
+                double distance = distances[i - first];
+
+                if (distance <= radius) {
+                    result.push_back({ cell_stops_[i], distance });
+                }
+
+            }
+
+        }
+
+        auto closer = [](const NearestStop& lhs, const NearestStop& rhs) {
+            return lhs.distance < rhs.distance
+                || (lhs.distance == rhs.distance && lhs.stop->stop_name < rhs.stop->stop_name);
+        };
+
+        if (result.size() > max_count) {
+            std::partial_sort(result.begin(), result.begin() + max_count, result.end(), closer);
+            result.resize(max_count);
+        }
+        else {
+            std::sort(result.begin(), result.end(), closer);
+        }
+
+        return result;
+    }
+
+    size_t StopsSpatialIndex::GetRow(double latitude) const {
+
+        double row = std::floor((latitude - min_lat_) / cell_lat_size_);
+        return static_cast<size_t>(std::clamp(row, 0.0, static_cast<double>(rows_ - 1)));
+    }
+
+    size_t StopsSpatialIndex::GetColumn(double longitude) const {
+
+        double column = std::floor((longitude - min_lng_) / cell_lng_size_);
+        return static_cast<size_t>(std::clamp(column, 0.0, static_cast<double>(columns_ - 1)));
+    }
+
+} // namespace transport_catalogue
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "domain.h"
+#include "geo.h"
+
+#include <vector>
+
+namespace transport_catalogue {
+
+    struct NearestStop {
+
+        const Stop* stop = nullptr;
+        double distance = 0.0;
+
+    };
+
+    // Uniform lat/lng grid over stops coordinates. Cells are kept in CSR form:
+    // the stops of cell i are cell_stops_[cell_offsets_[i] .. cell_offsets_[i + 1]).
+    // Coordinates are stored in the same order, so a row of candidate cells is one
+    // contiguous range for the batch distance kernel.
+    class StopsSpatialIndex {
+
+    public:
+
+        StopsSpatialIndex() = default;
+        // coordinates.Get(i) are the coordinates of stops[i]
+        StopsSpatialIndex(const std::vector<Stop*>& stops, const geo::CoordinatesColumns& coordinates);
+
+        std::vector<NearestStop> FindNearestStops(geo::Coordinates center, double radius, size_t max_count) const;
+
+    private:
+
+        size_t GetRow(double latitude) const;
+        size_t GetColumn(double longitude) const;
+
+        double min_lat_ = 0.0;
+        double min_lng_ = 0.0;
+        double cell_lat_size_ = 1.0;
+        double cell_lng_size_ = 1.0;
+        size_t rows_ = 0;
+        size_t columns_ = 0;
+
+        std::vector<size_t> cell_offsets_;
+        std::vector<const Stop*> cell_stops_;
+        geo::CoordinatesTable cell_coordinates_;
+
+    };
+
+} // namespace transport_catalogue
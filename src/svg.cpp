@@ -17,7 +17,7 @@ namespace svg {
 
         RenderObject(context);
 
-        context.out << std::endl;
+        context.out.put('\n');
     }
 
     std::ostream& operator<<(std::ostream& os, const StrokeLineCap& stroke_line_cap) {
@@ -91,9 +91,10 @@ namespace svg {
 
     void Circle::RenderObject(const RenderContext& context) const {
         auto& out = context.out;
-        out << "<circle cx=\""sv << center_.x << "\" cy=\""sv << center_.y << "\" "sv;
-        out << "r=\""sv << radius_ << "\""sv;
-        RenderAttrs(out);
+        const auto precision = context.precision;
+        out << "<circle cx=\""sv << numbers::Format(center_.x, precision) << "\" cy=\""sv << numbers::Format(center_.y, precision) << "\" "sv;
+        out << "r=\""sv << numbers::Format(radius_, precision) << "\""sv;
+        RenderAttrs(context);
         out << "/>"sv;
     }
 
@@ -107,16 +108,17 @@ namespace svg {
 
     void Polyline::RenderObject(const RenderContext& context) const {
         auto& out = context.out;
+        const auto precision = context.precision;
         out << "<polyline points=\""sv;
         int size = polyline_.size();
         for (int i = 0; i < size - 1; ++i) {
-            out << polyline_[i].x << ","sv << polyline_[i].y << " "sv;
+            out << numbers::Format(polyline_[i].x, precision) << ","sv << numbers::Format(polyline_[i].y, precision) << " "sv;
         }
         if (size != 0) {
-            out << polyline_[size - 1].x << ","sv << polyline_[size - 1].y;
+            out << numbers::Format(polyline_[size - 1].x, precision) << ","sv << numbers::Format(polyline_[size - 1].y, precision);
         }
         out << "\""sv;
-        RenderAttrs(out);
+        RenderAttrs(context);
         out << " />"sv;
     }
 
@@ -155,9 +157,10 @@ namespace svg {
 
     void Text::RenderObject(const RenderContext& context) const {
         auto& out = context.out;
-        out << "<text x=\""sv << control_point_.x << "\""sv << " y=\""sv << control_point_.y
-            << "\""sv << " dx=\""sv << control_point_offset_.x << "\""sv << " dy=\""sv
-            << control_point_offset_.y << "\""sv << " font-size=\""sv << font_size_ << "\""sv;
+        const auto precision = context.precision;
+        out << "<text x=\""sv << numbers::Format(control_point_.x, precision) << "\""sv << " y=\""sv << numbers::Format(control_point_.y, precision)
+            << "\""sv << " dx=\""sv << numbers::Format(control_point_offset_.x, precision) << "\""sv << " dy=\""sv
+            << numbers::Format(control_point_offset_.y, precision) << "\""sv << " font-size=\""sv << font_size_ << "\""sv;
 
         if (!font_family_.empty()) {
             out << " font-family=\""sv << font_family_ << "\""sv;
@@ -165,7 +168,7 @@ namespace svg {
         if (!font_weight_.empty()) {
             out << " font-weight=\""sv << font_weight_ << "\""sv;
         }
-        RenderAttrs(out);
+        RenderAttrs(context);
         out << ">"sv;
 
 
@@ -201,9 +204,9 @@ namespace svg {
         objects_.emplace_back(std::move(obj));
     }
 
-    void Document::Render(std::ostream& out) const {
+    void Document::Render(std::ostream& out, numbers::DoublePrecision precision) const {
 
-        RenderContext context(out);
+        RenderContext context(out, precision);
         out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n"sv;
         out << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">\n"sv;
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "numbers.h"
+
 #define _USE_MATH_DEFINES
 #include <cstdint>
 #include <iostream>
@@ -42,13 +44,15 @@ namespace svg {
     struct ColorVisitor {
 
         std::ostream& os;
+        numbers::DoublePrecision precision = numbers::DoublePrecision::Default;
         void operator()(const Rgb& rgb) {
             using namespace std::literals;
-            os << "rgb("sv << static_cast<size_t>(rgb.red) << ","sv << static_cast<size_t>(rgb.green) << ","sv << static_cast<size_t>(rgb.blue) << ")"sv;
+            os << "rgb("sv << numbers::Format(rgb.red) << ","sv << numbers::Format(rgb.green) << ","sv << numbers::Format(rgb.blue) << ")"sv;
         }
         void operator()(const Rgba& rgba) {
             using namespace std::literals;
-            os << "rgba("sv << static_cast<size_t>(rgba.red) << ","sv << static_cast<size_t>(rgba.green) << ","sv << static_cast<size_t>(rgba.blue) << ","sv << rgba.opacity << ")"sv;
+            os << "rgba("sv << numbers::Format(rgba.red) << ","sv << numbers::Format(rgba.green) << ","sv << numbers::Format(rgba.blue) << ","sv
+                << numbers::Format(rgba.opacity, precision) << ")"sv;
         }
         void operator()(std::monostate) {
             using namespace std::literals;
@@ -97,14 +101,20 @@ namespace svg {
             : out(out) {
         }
 
-        RenderContext(std::ostream& out, int indent_step, int indent = 0)
+        RenderContext(std::ostream& out, numbers::DoublePrecision precision)
+            : out(out)
+            , precision(precision) {
+        }
+
+        RenderContext(std::ostream& out, int indent_step, int indent = 0, numbers::DoublePrecision precision = numbers::DoublePrecision::Default)
             : out(out)
             , indent_step(indent_step)
-            , indent(indent) {
+            , indent(indent)
+            , precision(precision) {
         }
 
         RenderContext Indented() const {
-            return { out, indent_step, indent + indent_step };
+            return { out, indent_step, indent + indent_step, precision };
         }
 
         void RenderIndent() const {
@@ -116,6 +126,8 @@ namespace svg {
         std::ostream& out;
         int indent_step = 0;
         int indent = 0;
+        // How coordinates, sizes and opacities are written
+        numbers::DoublePrecision precision = numbers::DoublePrecision::Default;
     };
 
     template <typename Owner>
@@ -148,16 +160,21 @@ namespace svg {
 
     protected:
         ~PathProps() = default;
-        void RenderAttrs(std::ostream& out) const {
+        void RenderAttrs(const RenderContext& context) const {
             using namespace std::literals;
+            std::ostream& out = context.out;
             if (fill_color_) {
-                out << " fill=\""sv << *fill_color_ << "\""sv;
+                out << " fill=\""sv;
+                std::visit(ColorVisitor{ out, context.precision }, *fill_color_);
+                out << "\""sv;
             }
             if (stroke_color_) {
-                out << " stroke=\""sv << *stroke_color_ << "\""sv;
+                out << " stroke=\""sv;
+                std::visit(ColorVisitor{ out, context.precision }, *stroke_color_);
+                out << "\""sv;
             }
             if (stroke_width_) {
-                out << " stroke-width=\""sv << *stroke_width_ << "\""sv;
+                out << " stroke-width=\""sv << numbers::Format(*stroke_width_, context.precision) << "\""sv;
             }
             if (stroke_line_cap_) {
                 out << " stroke-linecap=\""sv << stroke_line_cap_.value() << "\""sv;
@@ -263,7 +280,7 @@ namespace svg {
     public:
         void AddPtr(std::unique_ptr<Object>&& obj) override;
 
-        void Render(std::ostream& out) const;
+        void Render(std::ostream& out, numbers::DoublePrecision precision = numbers::DoublePrecision::Default) const;
 
     private:
         std::vector<std::unique_ptr<Object>> objects_;
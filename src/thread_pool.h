@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed set of worker threads executing submitted tasks in FIFO order
+class ThreadPool {
+public:
+
+    explicit ThreadPool(size_t threads_count = std::thread::hardware_concurrency()) {
+
+        if (threads_count == 0) {
+            threads_count = 1;
+        }
+
+        workers_.reserve(threads_count);
+        for (size_t i = 0; i < threads_count; ++i) {
+            workers_.emplace_back([this] {
+                WorkerLoop();
+            });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard lock(mutex_);
+            stopped_ = true;
+        }
+        tasks_available_.notify_all();
+        for (std::thread& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    template <typename Task>
+    std::future<std::invoke_result_t<Task>> Submit(Task task) {
+
+        using Result = std::invoke_result_t<Task>;
+
+        // std::function needs a copyable callable, packaged_task is move-only
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+        std::future<Result> result = packaged->get_future();
+
+        {
+            std::lock_guard lock(mutex_);
+            tasks_.push([packaged] {
+                (*packaged)();
+            });
+        }
+        tasks_available_.notify_one();
+
+        return result;
+    }
+
+    // Splits [0, count) into about one contiguous range per thread, runs body(first, last) on
+    // each and waits for all of them. The first exception thrown by body is rethrown
+    template <typename Body>
+    void ParallelFor(size_t count, Body body) {
+
+        const size_t ranges_count = std::min(count, workers_.size());
+        std::vector<std::future<void>> ranges_done;
+        ranges_done.reserve(ranges_count);
+
+        for (size_t range = 0; range < ranges_count; ++range) {
+            const size_t first = count * range / ranges_count;
+            const size_t last = count * (range + 1) / ranges_count;
+            ranges_done.push_back(Submit([&body, first, last] {
+                body(first, last);
+            }));
+        }
+
+        for (auto& range_done : ranges_done) {
+            range_done.wait();
+        }
+        for (auto& range_done : ranges_done) {
+            range_done.get();
+        }
+    }
+
+    size_t GetThreadsCount() const {
+        return workers_.size();
+    }
+
+private:
+
+    void WorkerLoop() {
+
+        while (true) {
+
+            std::function<void()> task;
+
+            {
+                std::unique_lock lock(mutex_);
+                tasks_available_.wait(lock, [this] {
+                    return stopped_ || !tasks_.empty();
+                });
+
+                if (tasks_.empty()) {
+                    return;
+                }
+
+                task = std::move(tasks_.front());
+                tasks_.pop();
+            }
+
+            task();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable tasks_available_;
+    bool stopped_ = false;
+};
@@ -5,59 +5,215 @@ namespace transport_catalogue {
     using namespace geo;
     using namespace graph;
 
+    namespace {
+
+        size_t CountTrailingZeros(uint64_t word) {
+#if defined(__GNUC__)
+            return static_cast<size_t>(__builtin_ctzll(word));
+#else
+            size_t count = 0;
+            while ((word & 1) == 0) {
+                word >>= 1;
+                ++count;
+            }
+            return count;
+#endif
+        }
+
+        // Circle buses only ride along the stops order, forward buses also ride it back
+        std::optional<size_t> ComputeSpanCount(const Bus& bus, const Stop* stop_from, const Stop* stop_to) {
+
+            std::optional<size_t> span_count;
+            std::optional<size_t> last_from;
+            std::optional<size_t> last_to;
+
+            for (size_t i = 0; i < bus.stops.size(); ++i) {
+
+                if (bus.stops[i] == stop_from) {
+                    last_from = i;
+                }
+                if (bus.stops[i] == stop_to) {
+                    last_to = i;
+                }
+
+                if (bus.stops[i] == stop_to && last_from.has_value()) {
+                    span_count = std::min(span_count.value_or(i - *last_from), i - *last_from);
+                }
+                if (bus.type == BusType::Forward && bus.stops[i] == stop_from && last_to.has_value()) {
+                    span_count = std::min(span_count.value_or(i - *last_to), i - *last_to);
+                }
+
+            }
+
+            return span_count;
+        }
+
+    } // namespace
+
     void TransportCatalogue::AddStop(const std::string& stop, Coordinates coordinates) {
 
-        stops_list_.push_back({ stop, std::move(coordinates) });
-        auto& last_stop = stops_list_.back();
-        stops_.insert({ last_stop.stop_name, &last_stop });
-        stops_to_buses_.insert({ &last_stop, {} });
-        stops_to_indexes_.insert({ last_stop.stop_name, stops_to_indexes_.size() });
-        indexes_to_stops_.insert({ stops_to_indexes_.size() - 1, last_stop.stop_name });
+        if (auto stop_it = stops_.find(stop); stop_it != stops_.end()) {
+            stop_it->second->coordinates = coordinates;
+            return;
+        }
+
+        Stop* last_stop = arena_.Create<Stop>(arena_.CopyString(stop), coordinates);
+        stops_.insert({ last_stop->stop_name, last_stop });
+        stops_to_indexes_.insert({ last_stop->stop_name, indexes_to_stops_.size() });
+        indexes_to_stops_.push_back(last_stop);
     }
 
     void TransportCatalogue::AddBus(const std::string& bus, const std::vector<std::string>& stops, BusType route_type) {
 
         std::vector<Stop*> bus_stops;
+        bus_stops.reserve(stops.size());
 
         for (const std::string& stop : stops) {
             bus_stops.push_back(stops_.at(stop));
         }
 
-        bus_list_.push_back({ bus, route_type, std::move(bus_stops) });
-        auto& last_bus = bus_list_.back();
-        buses_.insert({ last_bus.bus_name, &last_bus });
+        AddBus(bus, bus_stops, route_type);
+    }
 
-        for (auto stop : last_bus.stops) {
-            stops_to_buses_.at(stop).insert(last_bus.bus_name);
+    void TransportCatalogue::AddBus(const std::string& bus, const std::vector<size_t>& stop_ids, BusType route_type) {
+
+        std::vector<Stop*> bus_stops;
+        bus_stops.reserve(stop_ids.size());
+
+        for (size_t stop_id : stop_ids) {
+            bus_stops.push_back(indexes_to_stops_.at(stop_id));
         }
 
+        AddBus(bus, bus_stops, route_type);
+    }
+
+    void TransportCatalogue::AddBus(const std::string& bus, const std::vector<Stop*>& bus_stops, BusType route_type) {
+
+        std::unordered_set<Stop*> unique_stops(bus_stops.begin(), bus_stops.end());
+
+        RemoveBus(bus);
+
+        Bus* last_bus = arena_.Create<Bus>(arena_.CopyString(bus), route_type, arena_.CopyArray(bus_stops), unique_stops.size());
+        buses_.insert({ last_bus->bus_name, last_bus });
+        buses_index_.insert({ last_bus->bus_name, last_bus });
+
     }
 
-    const Bus* TransportCatalogue::GetBus(const std::string& bus) const {
+    void TransportCatalogue::RemoveBus(std::string_view bus) {
+
+        auto bus_it = buses_index_.find(bus);
+
+        if (bus_it == buses_index_.end()) {
+            return;
+        }
+
+        // The Bus object itself stays in the arena until the whole catalogue is released
+        Bus* removed_bus = bus_it->second;
+
+        buses_.erase(removed_bus->bus_name);
+        buses_index_.erase(bus_it);
+    }
 
-        if (buses_.count(bus) == 0) {
+    void TransportCatalogue::RemoveStop(std::string_view stop) {
+
+        using namespace std::literals;
+
+        auto stop_it = stops_.find(stop);
+
+        if (stop_it == stops_.end()) {
+            return;
+        }
+
+        Stop* removed_stop = stop_it->second;
+
+        // Stop removal is rare, so the buses are scanned instead of keeping per stop counters
+        // that every bus change would have to maintain
+        bool is_used = std::any_of(buses_.begin(), buses_.end(), [removed_stop](const auto& bus) {
+            return std::find(bus.second->stops.begin(), bus.second->stops.end(), removed_stop) != bus.second->stops.end();
+        });
+
+        if (is_used) {
+            throw std::logic_error("Can't remove stop "s + std::string(removed_stop->stop_name) + " while buses pass through it"s);
+        }
+
+        for (auto distance_it = stops_distances_.begin(); distance_it != stops_distances_.end();) {
+
+            if (distance_it->first.first == removed_stop || distance_it->first.second == removed_stop) {
+                distance_it = stops_distances_.erase(distance_it);
+            }
+            else {
+                ++distance_it;
+            }
+
+        }
+
+        size_t removed_id = stops_to_indexes_.at(removed_stop->stop_name);
+        Stop* moved_stop = indexes_to_stops_.back();
+
+        indexes_to_stops_[removed_id] = moved_stop;
+        stops_to_indexes_[moved_stop->stop_name] = removed_id;
+        indexes_to_stops_.pop_back();
+
+        stops_to_indexes_.erase(removed_stop->stop_name);
+        stops_.erase(stop_it);
+    }
+
+    void TransportCatalogue::BuildIndexes() {
+        stops_coordinates_ = CoordinatesColumns(is_coordinates_quantized_);
+        stops_coordinates_.Reserve(indexes_to_stops_.size());
+        for (const Stop* stop : indexes_to_stops_) {
+            stops_coordinates_.Add(stop->coordinates);
+        }
+
+        stops_spatial_index_ = StopsSpatialIndex(indexes_to_stops_, stops_coordinates_);
+
+        BuildStopsToBuses();
+
+        std::vector<std::string_view> stops_names;
+        stops_names.reserve(indexes_to_stops_.size());
+        for (const Stop* stop : indexes_to_stops_) {
+            stops_names.push_back(stop->stop_name);
+        }
+        stops_names_index_ = NamesPrefixIndex(std::move(stops_names));
+
+        std::vector<std::string_view> buses_names;
+        buses_names.reserve(buses_.size());
+        for (const auto& [bus_name, _] : buses_) {
+            buses_names.push_back(bus_name);
+        }
+        buses_names_index_ = NamesPrefixIndex(std::move(buses_names));
+    }
+
+    const Bus* TransportCatalogue::GetBus(std::string_view bus) const {
+
+        auto bus_it = buses_index_.find(bus);
+
+        if (bus_it == buses_index_.end()) {
             return nullptr;
         }
 
-        return static_cast<const Bus*>(buses_.at(bus));
+        return bus_it->second;
     }
 
-    const Stop* TransportCatalogue::GetStop(const std::string& stop) const {
+    const Stop* TransportCatalogue::GetStop(std::string_view stop) const {
+
+        auto stop_it = stops_.find(stop);
 
-        if (stops_.count(stop) == 0) {
+        if (stop_it == stops_.end()) {
             return nullptr;
         }
 
-        return static_cast<const Stop*>(stops_.at(stop));
+        return stop_it->second;
     }
 
-    std::optional<BusInformation> TransportCatalogue::GetBusInformation(const std::string& route) const {
+    std::optional<BusInformation> TransportCatalogue::GetBusInformation(std::string_view route) const {
 
-        if (buses_.count(route) == 0) {
+        const Bus* finded_route = GetBus(route);
+
+        if (finded_route == nullptr) {
             return std::nullopt;
         }
 
-        Bus* finded_route = buses_.at(route);
         size_t stops_count = finded_route->stops.size();
 
         if (stops_count == 0) {
@@ -65,7 +221,7 @@ namespace transport_catalogue {
         }
 
 
-        const std::vector<Stop*> route_stops = finded_route->stops;
+        const auto& route_stops = finded_route->stops;
 
         size_t route_length = 0;
         double geographical_distance = 0.0;
@@ -89,8 +245,7 @@ namespace transport_catalogue {
 
         }
 
-        std::unordered_set<Stop*> unique_stops(route_stops.begin(), route_stops.end());
-        size_t unique_stops_count = unique_stops.size();
+        size_t unique_stops_count = finded_route->unique_stops_count;
         double curvature = route_length / geographical_distance;
 
 
@@ -98,43 +253,156 @@ namespace transport_catalogue {
 
     }
 
-    std::optional<const std::set<std::string_view>> TransportCatalogue::GetStopInformation(const std::string& stop) const {
+    std::optional<ranges::Span<const std::string_view>> TransportCatalogue::GetStopInformation(std::string_view stop) const {
+
+        auto stop_it = stops_to_indexes_.find(stop);
+
+        if (stop_it == stops_to_indexes_.end()) {
+            return std::nullopt;
+        }
+
+        size_t begin = stops_to_buses_offsets_.at(stop_it->second);
+        size_t end = stops_to_buses_offsets_.at(stop_it->second + 1);
+
+        return ranges::Span<const std::string_view>(stops_to_buses_.data() + begin, end - begin);
+
+    }
+
+    std::optional<std::vector<DirectBus>> TransportCatalogue::GetDirectBuses(std::string_view stop_from, std::string_view stop_to) const {
 
-        if (stops_.count(stop) == 0) {
+        auto from_it = stops_to_indexes_.find(stop_from);
+        auto to_it = stops_to_indexes_.find(stop_to);
+
+        if (from_it == stops_to_indexes_.end() || to_it == stops_to_indexes_.end()) {
             return std::nullopt;
         }
 
-        Stop* searched_stop = stops_.at(stop);
-        return stops_to_buses_.at(searched_stop);
+        const uint64_t* from_bits = stops_buses_bits_.data() + from_it->second * bus_words_count_;
+        const uint64_t* to_bits = stops_buses_bits_.data() + to_it->second * bus_words_count_;
+        const Stop* from = indexes_to_stops_[from_it->second];
+        const Stop* to = indexes_to_stops_[to_it->second];
+
+        std::vector<DirectBus> direct_buses;
+
+        for (size_t word = 0; word < bus_words_count_; ++word) {
+
+            uint64_t common_buses = from_bits[word] & to_bits[word];
+
+            while (common_buses != 0) {
+
+                const Bus* bus = buses_by_number_[word * 64 + CountTrailingZeros(common_buses)];
+                common_buses &= common_buses - 1;
+
+                // Sharing both stops is not enough for a circle bus going the wrong way round
+                if (auto span_count = ComputeSpanCount(*bus, from, to)) {
+                    direct_buses.push_back(DirectBus{ bus, *span_count });
+                }
+
+            }
+
+        }
+
+        return direct_buses;
+    }
+
+    void TransportCatalogue::BuildStopsToBuses() {
+
+        const size_t stops_count = indexes_to_stops_.size();
+
+        std::unordered_map<const Stop*, size_t> stops_ids;
+        stops_ids.reserve(stops_count);
+        for (size_t stop_id = 0; stop_id < stops_count; ++stop_id) {
+            stops_ids.emplace(indexes_to_stops_[stop_id], stop_id);
+        }
+
+        // Buses are visited in name order, so every stop range comes out sorted. The last seen bus
+        // number of each stop drops repeated stops of one bus
+        std::vector<size_t> last_bus(stops_count, 0);
+        std::vector<size_t> buses_counts(stops_count + 1, 0);
+
+        buses_by_number_.clear();
+        buses_by_number_.reserve(buses_.size());
+        bus_words_count_ = (buses_.size() + 63) / 64;
+        stops_buses_bits_.assign(stops_count * bus_words_count_, 0);
+
+        size_t bus_number = 0;
+        for (const auto& [_, bus] : buses_) {
+            buses_by_number_.push_back(bus);
+            ++bus_number;
+            for (const Stop* stop : bus->stops) {
+                size_t stop_id = stops_ids.at(stop);
+                if (last_bus[stop_id] != bus_number) {
+                    last_bus[stop_id] = bus_number;
+                    ++buses_counts[stop_id + 1];
+                    stops_buses_bits_[stop_id * bus_words_count_ + (bus_number - 1) / 64] |= uint64_t{ 1 } << ((bus_number - 1) % 64);
+                }
+            }
+        }
+
+        std::partial_sum(buses_counts.begin(), buses_counts.end(), buses_counts.begin());
+        stops_to_buses_offsets_ = buses_counts;
+        stops_to_buses_.assign(stops_to_buses_offsets_.back(), std::string_view{});
+
+        std::fill(last_bus.begin(), last_bus.end(), 0);
+
+        bus_number = 0;
+        for (const auto& [bus_name, bus] : buses_) {
+            ++bus_number;
+            for (const Stop* stop : bus->stops) {
+                size_t stop_id = stops_ids.at(stop);
+                if (last_bus[stop_id] != bus_number) {
+                    last_bus[stop_id] = bus_number;
+                    stops_to_buses_[buses_counts[stop_id]++] = bus_name;
+                }
+            }
+        }
 
     }
 
     void TransportCatalogue::SetDistanceBetweenStops(std::string_view stop_from, std::string_view stop_to, size_t distance) {
-        
-        if (stops_.count(stop_from) == 0 || stops_.count(stop_to) == 0) {
+
+        auto stop_from_it = stops_.find(stop_from);
+        auto stop_to_it = stops_.find(stop_to);
+
+        if (stop_from_it == stops_.end() || stop_to_it == stops_.end()) {
             return;
         }
 
-        stops_distances_.insert({ std::make_pair(stops_.at(stop_from), stops_.at(stop_to)), distance });
+        stops_distances_.insert_or_assign(std::make_pair(stop_from_it->second, stop_to_it->second), distance);
         
     }
 
+    void TransportCatalogue::SetDistanceBetweenStops(size_t stop_from_id, size_t stop_to_id, size_t distance) {
+        stops_distances_.insert_or_assign(std::make_pair(indexes_to_stops_.at(stop_from_id), indexes_to_stops_.at(stop_to_id)), distance);
+    }
+
+    void TransportCatalogue::RemoveDistanceBetweenStops(std::string_view stop_from, std::string_view stop_to) {
+
+        auto stop_from_it = stops_.find(stop_from);
+        auto stop_to_it = stops_.find(stop_to);
+
+        if (stop_from_it == stops_.end() || stop_to_it == stops_.end()) {
+            return;
+        }
+
+        stops_distances_.erase(std::make_pair(stop_from_it->second, stop_to_it->second));
+    }
+
     size_t TransportCatalogue::GetDistanceBetweenStops(Stop* stop_from, Stop* stop_to) const {
 
-        auto search_key = std::make_pair(stop_from, stop_to);
+        auto distance_it = stops_distances_.find(std::make_pair(stop_from, stop_to));
 
-        if (stops_distances_.count(search_key) == 0) {
+        if (distance_it == stops_distances_.end()) {
 
-            auto another_search_key = std::make_pair(stop_to, stop_from);
+            distance_it = stops_distances_.find(std::make_pair(stop_to, stop_from));
 
-            if (stops_distances_.count(another_search_key) == 0) {
+            if (distance_it == stops_distances_.end()) {
                 return 0;
             }
 
-            return stops_distances_.at(another_search_key);
         }
 
-        return stops_distances_.at(search_key);
+        return distance_it->second;
 
     }
 
@@ -142,8 +410,8 @@ namespace transport_catalogue {
         return buses_;
     }
     
-    const std::deque<Stop>& TransportCatalogue::GetAllStops() const {
-        return stops_list_;
+    const std::vector<Stop*>& TransportCatalogue::GetAllStops() const {
+        return indexes_to_stops_;
     }
 
     const std::unordered_map<std::pair<Stop*, Stop*>, size_t, StopsHasher>& TransportCatalogue::GetDistancesListBetweenStops() const {
@@ -151,15 +419,50 @@ namespace transport_catalogue {
     }
     
     size_t TransportCatalogue::GetStopsCount() const {
-        return stops_list_.size();
+        return indexes_to_stops_.size();
     }
 
     size_t TransportCatalogue::GetStopId(std::string_view stop) const {
         return stops_to_indexes_.at(stop);
     }
 
+    std::optional<size_t> TransportCatalogue::TryGetStopId(std::string_view stop) const {
+
+        auto stop_it = stops_to_indexes_.find(stop);
+
+        if (stop_it == stops_to_indexes_.end()) {
+            return std::nullopt;
+        }
+
+        return stop_it->second;
+    }
+
     std::string_view TransportCatalogue::GetStopNameById(size_t vertex_id) const {
-        return indexes_to_stops_.at(vertex_id);
+        return indexes_to_stops_.at(vertex_id)->stop_name;
+    }
+
+    void TransportCatalogue::SetCoordinatesQuantized(bool is_quantized) {
+        is_coordinates_quantized_ = is_quantized;
+    }
+
+    bool TransportCatalogue::IsCoordinatesQuantized() const {
+        return is_coordinates_quantized_;
+    }
+
+    const CoordinatesColumns& TransportCatalogue::GetStopsCoordinates() const {
+        return stops_coordinates_;
+    }
+
+    std::vector<NearestStop> TransportCatalogue::GetNearestStops(Coordinates center, double radius, size_t max_count) const {
+        return stops_spatial_index_.FindNearestStops(center, radius, max_count);
+    }
+
+    std::vector<std::string_view> TransportCatalogue::SuggestStops(std::string_view prefix, size_t max_count) const {
+        return stops_names_index_.FindByPrefix(prefix, max_count);
+    }
+
+    std::vector<std::string_view> TransportCatalogue::SuggestBuses(std::string_view prefix, size_t max_count) const {
+        return buses_names_index_.FindByPrefix(prefix, max_count);
     }
 
 } // namespace trasport_catalogue
\ No newline at end of file
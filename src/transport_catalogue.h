@@ -1,11 +1,14 @@
 #pragma once
 
 #include "domain.h"
+#include "arena.h"
 #include "graph.h"
+#include "prefix_index.h"
+#include "spatial_index.h"
 
 #include <algorithm>
-#include <deque>
 #include <cmath>
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <numeric>
@@ -13,6 +16,7 @@
 #include <set>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -25,37 +29,84 @@ namespace transport_catalogue {
 
     public:
 
+        // Adding an existing stop moves it to the new coordinates, adding an existing bus replaces it
         void AddStop(const std::string& stop, geo::Coordinates coordinates);
         void AddBus(const std::string& route, const std::vector<std::string>& stops, BusType route_type);
+        // Same as above with the stops given by ids, for loaders that resolved the names beforehand
+        void AddBus(const std::string& route, const std::vector<size_t>& stop_ids, BusType route_type);
 
-        const Bus* GetBus(const std::string& route) const;
-        const Stop* GetStop(const std::string& stop) const;
+        void RemoveBus(std::string_view route);
+        // A stop can be removed only when no bus passes through it. The last stop takes over the id
+        // of the removed one, so stop ids stay dense
+        void RemoveStop(std::string_view stop);
 
-        std::optional<BusInformation> GetBusInformation(const std::string& route) const;
-        std::optional<const std::set<std::string_view>> GetStopInformation(const std::string& stop) const;
+        // Builds lookup structures over the filled catalogue, call after all stops and buses are added
+        void BuildIndexes();
+
+        // Keeps the stops coordinates table, and the serialized base, in int32 micro-degrees
+        void SetCoordinatesQuantized(bool is_quantized);
+        bool IsCoordinatesQuantized() const;
+
+        const Bus* GetBus(std::string_view route) const;
+        const Stop* GetStop(std::string_view stop) const;
+
+        std::optional<BusInformation> GetBusInformation(std::string_view route) const;
+        // Names of the buses passing through the stop in lexicographic order, valid after BuildIndexes
+        std::optional<ranges::Span<const std::string_view>> GetStopInformation(std::string_view stop) const;
+        // Buses going from stop_from to stop_to without transfers in name order, valid after BuildIndexes
+        std::optional<std::vector<DirectBus>> GetDirectBuses(std::string_view stop_from, std::string_view stop_to) const;
 
         void SetDistanceBetweenStops(std::string_view stop_from, std::string_view stop_to, size_t distance);
+        void SetDistanceBetweenStops(size_t stop_from_id, size_t stop_to_id, size_t distance);
+        // Drops the distance given from stop_from to stop_to. The reverse one, if any, then serves both ways
+        void RemoveDistanceBetweenStops(std::string_view stop_from, std::string_view stop_to);
         size_t GetDistanceBetweenStops(Stop* stop_from, Stop* stop_to) const;
         const std::unordered_map<std::pair<Stop*, Stop*>, size_t, StopsHasher>& GetDistancesListBetweenStops() const;
         
         const std::map<std::string_view, Bus*>& GetAllBuses() const;
-        const std::deque<Stop>& GetAllStops() const;
+        const std::vector<Stop*>& GetAllStops() const;
         
         size_t GetStopsCount() const;
         size_t GetStopId(std::string_view stop) const;
+        std::optional<size_t> TryGetStopId(std::string_view stop) const;
         std::string_view GetStopNameById(size_t vertex_id) const;
 
+        // Coordinates of the stops by stop id, valid after BuildIndexes
+        const geo::CoordinatesColumns& GetStopsCoordinates() const;
+
+        std::vector<NearestStop> GetNearestStops(geo::Coordinates center, double radius, size_t max_count) const;
+
+        std::vector<std::string_view> SuggestStops(std::string_view prefix, size_t max_count) const;
+        std::vector<std::string_view> SuggestBuses(std::string_view prefix, size_t max_count) const;
+
 
     private:
 
+        void AddBus(const std::string& route, const std::vector<Stop*>& bus_stops, BusType route_type);
+        void BuildStopsToBuses();
+
+        // Owns all Stop and Bus objects with their names and stop sequences, declared first so
+        // that it outlives the indexes pointing into it
+        memory::MonotonicArena arena_;
         std::map<std::string_view, Bus*> buses_;
+        std::unordered_map<std::string_view, Bus*> buses_index_;
         std::unordered_map<std::string_view, Stop*> stops_;
-        std::unordered_map<Stop*, std::set<std::string_view>> stops_to_buses_;
         std::unordered_map<std::pair<Stop*, Stop*>, size_t, StopsHasher> stops_distances_;
         std::unordered_map<std::string_view, size_t> stops_to_indexes_;
-        std::unordered_map<std::size_t, std::string_view> indexes_to_stops_;
-        std::deque<Stop> stops_list_;
-        std::deque<Bus> bus_list_;
+        std::vector<Stop*> indexes_to_stops_;
+        // Buses of the stop with id i are stops_to_buses_[stops_to_buses_offsets_[i] .. stops_to_buses_offsets_[i + 1])
+        std::vector<size_t> stops_to_buses_offsets_;
+        std::vector<std::string_view> stops_to_buses_;
+        // Bit b of the stop with id i is set when the b-th bus in name order passes through it,
+        // the stop bits are stops_buses_bits_[i * bus_words_count_ .. (i + 1) * bus_words_count_)
+        std::vector<const Bus*> buses_by_number_;
+        std::vector<uint64_t> stops_buses_bits_;
+        size_t bus_words_count_ = 0;
+        bool is_coordinates_quantized_ = false;
+        geo::CoordinatesColumns stops_coordinates_;
+        StopsSpatialIndex stops_spatial_index_;
+        NamesPrefixIndex stops_names_index_;
+        NamesPrefixIndex buses_names_index_;
     };
 
 } // namespace transport_catalogue
\ No newline at end of file
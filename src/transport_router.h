@@ -36,7 +36,7 @@ private:
         std::string_view bus_name;
         double bus_speed = 0.0;
         int bus_wait_time = 0;
-        const std::vector<Stop*>& bus_stops_list;
+        ranges::Span<Stop*> bus_stops_list;
 
     };
 
@@ -66,7 +66,7 @@ std::vector<size_t> TransportRouterBuilder::SplitRouteIntoIntervals(const InputI
 
     std::vector<size_t> result;
 
-    for (InputIt first_it = first, second_it = next(first); second_it != last; first_it++, second_it++) {
+    for (InputIt first_it = first, second_it = std::next(first); second_it != last; first_it++, second_it++) {
 
         auto from = *first_it;
         auto to = *second_it;
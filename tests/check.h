@@ -0,0 +1,24 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+
+// Minimal checks for the test executables: a failed check is printed and counted, and main
+// returns nonzero if any failed, so ctest reports the executable as failed
+namespace testing {
+
+    inline int failures_count = 0;
+
+    inline void Check(bool condition, const std::string& what) {
+        if (!condition) {
+            ++failures_count;
+            std::cerr << "Check failed: " << what << '\n';
+        }
+    }
+
+    inline int Finish(const std::string& test_name) {
+        std::cerr << test_name << (failures_count == 0 ? ": OK\n" : ": FAILED\n");
+        return failures_count == 0 ? 0 : 1;
+    }
+
+}  // namespace testing
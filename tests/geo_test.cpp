@@ -0,0 +1,92 @@
+#include "../src/geo.h"
+#include "check.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+    // The sphere and the degree conversion geo.cpp uses
+    const long double EARTH_RADIUS = 6371000;
+    const long double DEGREES_TO_RADIANS = 3.1415926535L / 180.0L;
+
+    long double ExactHaversine(geo::Coordinates from, geo::Coordinates to) {
+        const long double half_dlat = (to.lat - from.lat) * DEGREES_TO_RADIANS / 2;
+        const long double half_dlng = (to.lng - from.lng) * DEGREES_TO_RADIANS / 2;
+        const long double h = std::sin(half_dlat) * std::sin(half_dlat)
+            + std::cos(from.lat * DEGREES_TO_RADIANS) * std::cos(to.lat * DEGREES_TO_RADIANS) * std::sin(half_dlng) * std::sin(half_dlng);
+        return 2 * EARTH_RADIUS * std::asin(std::sqrt(std::min(h, 1.0L)));
+    }
+
+    std::string Describe(geo::Coordinates from, geo::Coordinates to, double distance, long double expected) {
+        return "("s + std::to_string(from.lat) + ", "s + std::to_string(from.lng) + ") - ("s + std::to_string(to.lat)
+            + ", "s + std::to_string(to.lng) + "): "s + std::to_string(distance) + " instead of "s + std::to_string(static_cast<double>(expected));
+    }
+
+    // Points around a city and across the globe, the same point and antipodes included
+    std::vector<geo::Coordinates> MakePoints(geo::Coordinates center, double spread, size_t count, std::mt19937& generator) {
+
+        std::uniform_real_distribution<double> offset(-spread, spread);
+        std::vector<geo::Coordinates> points{ center, { -center.lat, center.lng + 180.0 } };
+
+        while (points.size() < count) {
+            points.emplace_back(std::clamp(center.lat + offset(generator), -90.0, 90.0), center.lng + offset(generator));
+        }
+
+        return points;
+    }
+
+    void TestTableDistances(geo::Coordinates center, double spread) {
+
+        std::mt19937 generator(42);
+        const std::vector<geo::Coordinates> points = MakePoints(center, spread, 1000, generator);
+
+        geo::CoordinatesTable table;
+        table.Reserve(points.size());
+        for (geo::Coordinates point : points) {
+            table.Add(point);
+        }
+
+        testing::Check(table.Size() == points.size(), "CoordinatesTable keeps every point"s);
+
+        std::vector<double> distances(points.size());
+
+        for (size_t from = 0; from < points.size(); from += 37) {
+
+            // An unaligned range, so the vector loop and its tail both run
+            const size_t first = from % 5;
+            geo::ComputeDistances(points[from], table, first, points.size(), distances.data());
+
+            for (size_t i = first; i < points.size(); ++i) {
+
+                const double distance = distances[i - first];
+                const long double exact = ExactHaversine(points[from], points[i]);
+
+                // The documented bound, with an absolute floor for coinciding points
+                testing::Check(std::abs(distance - exact) <= 2e-9L * exact + 1e-6L,
+                    "haversine "s + Describe(points[from], points[i], distance, exact));
+
+                // ComputeDistance uses acos, whose rounding costs up to about 0.1 m near antipodal points
+                const double reference = geo::ComputeDistance(points[from], points[i]);
+                testing::Check(std::abs(distance - reference) <= 1e-9 * reference + 0.2,
+                    "ComputeDistance "s + Describe(points[from], points[i], distance, reference));
+            }
+        }
+    }
+
+}  // namespace
+
+int main() {
+
+    // A city, a city far from the equator, and points anywhere on the globe
+    TestTableDistances({ 43.58, 39.72 }, 0.3);
+    TestTableDistances({ 69.0, 33.1 }, 0.3);
+    TestTableDistances({ 0.0, 0.0 }, 180.0);
+
+    return testing::Finish("geo_test"s);
+}
@@ -0,0 +1,263 @@
+#include "../src/json.h"
+#include "../src/thread_pool.h"
+#include "check.h"
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+    // Bytewise reference of the escaping Print does
+    std::string Quote(std::string_view value) {
+        std::string result = "\""s;
+        for (const char c : value) {
+            switch (c) {
+            case '"':
+                result += "\\\""sv;
+                break;
+            case '\\':
+                result += "\\\\"sv;
+                break;
+            case '\n':
+                result += "\\n"sv;
+                break;
+            case '\r':
+                result += "\\r"sv;
+                break;
+            case '\t':
+                result += "\\t"sv;
+                break;
+            case '\b':
+                result += "\\b"sv;
+                break;
+            case '\f':
+                result += "\\f"sv;
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char code[7];
+                    std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned>(c));
+                    result += code;
+                }
+                else {
+                    result += c;
+                }
+                break;
+            }
+        }
+        result += '"';
+        return result;
+    }
+
+    std::string PrintCompact(const json::Document& document) {
+        json::PrintOptions options;
+        options.compact = true;
+        std::ostringstream output;
+        json::Print(document, output, options);
+        return output.str();
+    }
+
+    // The printed document, or the error, so that outcomes can be compared as strings
+    template <typename LoadFunction>
+    std::string Outcome(LoadFunction load) {
+        try {
+            return PrintCompact(load());
+        }
+        catch (const json::ParsingError& error) {
+            return "ParsingError: "s + error.what();
+        }
+    }
+
+    // Strings longer than two 32-byte vectors, with two special characters at every pair of
+    // positions, so the string ends and escapes the classifiers look for fall at each offset
+    // within a vector, across the boundary between vectors and in the bytewise tail
+    void TestStrings() {
+
+        constexpr std::string_view specials = "\"\\\n\r\t\b\f\x01\x1f/ \x7f\xd0"sv;
+        constexpr size_t MAX_LENGTH = 70;
+
+        size_t pair_index = 0;
+        for (size_t length = 0; length <= MAX_LENGTH; ++length) {
+            for (size_t first = 0; first <= length; ++first) {
+                for (size_t second = first; second <= length; ++second, ++pair_index) {
+
+                    std::string value(length, 'a');
+                    if (first < length) {
+                        value[first] = specials[pair_index % specials.size()];
+                    }
+                    if (second < length) {
+                        value[second] = specials[pair_index / specials.size() % specials.size()];
+                    }
+
+                    const std::string text = Quote(value);
+                    const std::string what = "string "s + text;
+
+                    testing::Check(Outcome([&text] { return json::Load(text); }) == text, "Load of "s + what);
+
+                    std::istringstream input(text);
+                    testing::Check(Outcome([&input] { return json::Load(input); }) == text, "Load from a stream of "s + what);
+
+                    testing::Check(PrintCompact(json::Document{ json::Node{ value } }) == text, "Print of "s + what);
+
+                    std::string appended = "x"s;
+                    json::AppendString(appended, value);
+                    testing::Check(appended == "x"s + text, "AppendString of "s + what);
+                }
+            }
+        }
+    }
+
+    // Raw line breaks end a string with an error wherever they are, other raw control
+    // characters are kept
+    void TestRawCharacters() {
+        for (size_t length = 1; length <= 70; ++length) {
+            for (size_t position = 0; position < length; ++position) {
+                for (const char c : "\n\r"sv) {
+                    std::string text = "\""s + std::string(length, 'a') + "\""s;
+                    text[position + 1] = c;
+                    testing::Check(Outcome([&text] { return json::Load(text); }).rfind("ParsingError: "s, 0) == 0,
+                        "a raw line break at "s + std::to_string(position) + " of "s + std::to_string(length) + " is rejected"s);
+                }
+
+                std::string value(length, 'a');
+                value[position] = '\t';
+                const std::string text = "\""s + value + "\""s;
+                testing::Check(Outcome([&text] { return json::Load(text); }) == Quote(value),
+                    "a raw tab at "s + std::to_string(position) + " of "s + std::to_string(length) + " is kept"s);
+            }
+        }
+    }
+
+    // Runs of whitespace of every length around the values and separators
+    void TestWhitespace() {
+        constexpr std::string_view whitespace = " \t\n\r"sv;
+        for (size_t length = 0; length <= 70; ++length) {
+            std::string run;
+            for (size_t i = 0; i < length; ++i) {
+                run += whitespace[(i * 7 + length) % whitespace.size()];
+            }
+
+            const std::string text = run + "{"s + run + "\"a\""s + run + ":"s + run + "["s + run + "1"s + run + ","s + run
+                + "\"b\""s + run + "]"s + run + "}"s + run;
+            testing::Check(Outcome([&text] { return json::Load(text); }) == R"({"a":[1,"b"]})"s,
+                "whitespace runs of "s + std::to_string(length));
+        }
+    }
+
+    // Parser::MIN_PARALLEL_ARRAY_SIZE in json.cpp: arrays from this many bytes between the
+    // brackets are split among the pool
+    constexpr size_t MIN_PARALLEL_ARRAY_SIZE = 64 * 1024;
+
+    // Elements with commas, brackets and escapes inside strings and nested containers, which
+    // the scan for element bounds has to skip
+    std::string MakeElement(size_t index) {
+        switch (index % 6) {
+        case 0:
+            return std::to_string(index);
+        case 1:
+            return "-1.5e3"s;
+        case 2:
+            return Quote("a,b]}"s + std::string(index % 40, 'x') + "\"\\[{\n"s);
+        case 3:
+            return R"({"k": [1, "x,]", {"y": "}"}], "n": null})"s;
+        case 4:
+            return "[true, false, [ ], \"\\\\\"]"s;
+        default:
+            return R"("\u00e9\ud83d\ude00\"")"s;
+        }
+    }
+
+    // The text between the brackets of an array, exactly size bytes long, with bad in place of
+    // the element at bad_index
+    std::string MakeArrayBody(size_t size, std::string_view bad = {}, size_t bad_index = 0) {
+        std::string body;
+        for (size_t index = 0;; ++index) {
+            const std::string element = !bad.empty() && index == bad_index ? std::string(bad) : MakeElement(index);
+            const size_t separator_size = body.empty() ? 0 : 2;
+            if (body.size() + separator_size + element.size() > size) {
+                break;
+            }
+            if (separator_size != 0) {
+                body += ", "sv;
+            }
+            body += element;
+        }
+        body.resize(size, ' ');
+        return body;
+    }
+
+    void CheckSameOutcome(const std::string& text, ThreadPool& thread_pool, const std::string& what) {
+        const std::string serial = Outcome([&text] { return json::Load(text); });
+        const std::string parallel = Outcome([&text, &thread_pool] { return json::Load(text, thread_pool); });
+        testing::Check(serial == parallel, what + ": "s + parallel.substr(0, 200) + " instead of "s + serial.substr(0, 200));
+    }
+
+    // Arrays just below, at and above the size the parallel parse starts at, as the root and as
+    // values of the root dict, give the Document of the serial parse
+    void TestParallelArrays(ThreadPool& thread_pool) {
+        for (const size_t size : { MIN_PARALLEL_ARRAY_SIZE - 1, MIN_PARALLEL_ARRAY_SIZE, MIN_PARALLEL_ARRAY_SIZE + 1, 4 * MIN_PARALLEL_ARRAY_SIZE }) {
+            const std::string body = MakeArrayBody(size);
+            const std::string what = "array of "s + std::to_string(size) + " bytes"s;
+
+            const std::string root_array = "["s + body + "]"s;
+            CheckSameOutcome(root_array, thread_pool, "root "s + what);
+            testing::Check(Outcome([&root_array] { return json::Load(root_array); }).rfind("ParsingError"s, 0) != 0, "root "s + what + " is parsed"s);
+
+            CheckSameOutcome("{\"a\": ["s + body + "], \"b\": [1, 2], \"c\": [["s + body + "]]}"s, thread_pool, "dict of "s + what);
+        }
+    }
+
+    // An element the split parse rejects or reads differently makes the whole text parse again
+    // serially, so the outcome, the error included, is that of the serial parse
+    void TestMalformedArrays(ThreadPool& thread_pool) {
+        const std::vector<std::string_view> bad_elements = {
+            "1 2"sv, // accepted by the serial grammar only
+            "[1 2]"sv,
+            "\"abc"sv, // an unterminated string
+            "\"a\nb\""sv, // a raw line break
+            "\"a\\q\""sv, // an unknown escape
+            "tru"sv,
+            "{\"a\": 1]"sv, // mismatched brackets
+            "[1, 2"sv,
+            "{\"a\": 1, \"a\": 2}"sv, // a duplicate key
+            "1,,2"sv,
+            "01"sv,
+        };
+
+        const size_t size = 2 * MIN_PARALLEL_ARRAY_SIZE;
+        for (const std::string_view bad : bad_elements) {
+            for (const size_t bad_index : { size_t{ 0 }, size_t{ 1000 }, size_t{ 3000 } }) {
+                const std::string body = MakeArrayBody(size, bad, bad_index);
+                const std::string what = "'"s + std::string(bad) + "' at "s + std::to_string(bad_index);
+                CheckSameOutcome("["s + body + "]"s, thread_pool, what);
+                CheckSameOutcome("{\"a\": ["s + body + "]}"s, thread_pool, what + " in a dict"s);
+            }
+        }
+
+        // Texts cut short inside the array
+        const std::string text = "["s + MakeArrayBody(size) + "]"s;
+        for (const size_t cut : { size_t{ 1 }, text.size() / 2, text.size() - 1 }) {
+            CheckSameOutcome(text.substr(0, cut), thread_pool, "text cut at "s + std::to_string(cut));
+        }
+    }
+
+}  // namespace
+
+int main() {
+
+    TestStrings();
+    TestRawCharacters();
+    TestWhitespace();
+
+    // More threads than the machine may have, the parallel parse only needs more than one
+    ThreadPool thread_pool(4);
+    TestParallelArrays(thread_pool);
+    TestMalformedArrays(thread_pool);
+
+    return testing::Finish("json_test"s);
+}